@@ -1,6 +1,7 @@
 QT += \
     widgets \
-    webkitwidgets
+    webkitwidgets \
+    network
 
 SOURCES += \
     main.cpp \
@@ -11,7 +12,37 @@ SOURCES += \
     lefttabwidget.cpp \
     fileiconprovider.cpp \
     tabbar.cpp \
-    findfiledialog.cpp
+    findfiledialog.cpp \
+    textbuffer.cpp \
+    minimap.cpp \
+    projectfiles.cpp \
+    wordindex.cpp \
+    symbolindex.cpp \
+    findsymboldialog.cpp \
+    fileoperationqueue.cpp \
+    outputview.cpp \
+    runnerpanel.cpp \
+    linediff.cpp \
+    comparedialog.cpp \
+    projectreplace.cpp \
+    replacedialog.cpp \
+    resourcemonitor.cpp \
+    singleinstance.cpp \
+    whitespacenormalizer.cpp \
+    gitignore.cpp \
+    projectmodel.cpp \
+    gitstatus.cpp \
+    bridgemonitor.cpp \
+    typingbenchmark.cpp \
+    compressedfile.cpp \
+    structureindex.cpp \
+    outlinepanel.cpp \
+    csvview.cpp \
+    documentsearch.cpp \
+    findbar.cpp \
+    longlines.cpp \
+    contentcache.cpp \
+    markdownpreview.cpp
 
 HEADERS += \
     mainwindow.h \
@@ -21,7 +52,45 @@ HEADERS += \
     lefttabwidget.h \
     fileiconprovider.h \
     tabbar.h \
-    findfiledialog.h
+    findfiledialog.h \
+    textbuffer.h \
+    minimap.h \
+    projectfiles.h \
+    wordindex.h \
+    symbolindex.h \
+    findsymboldialog.h \
+    fileoperationqueue.h \
+    outputview.h \
+    runnerpanel.h \
+    linediff.h \
+    comparedialog.h \
+    projectreplace.h \
+    replacedialog.h \
+    resourcemonitor.h \
+    singleinstance.h \
+    whitespacenormalizer.h \
+    gitignore.h \
+    projectmodel.h \
+    gitstatus.h \
+    bridgemonitor.h \
+    typingbenchmark.h \
+    compressedfile.h \
+    structureindex.h \
+    outlinepanel.h \
+    csvview.h \
+    documentsearch.h \
+    findbar.h \
+    longlines.h \
+    contentcache.h \
+    markdownpreview.h
+
+LIBS += -lz
+
+#zstd is optional, gzip support only needs zlib
+packagesExist(libzstd) {
+    DEFINES += NEOEDITOR_ZSTD
+    LIBS += -lzstd
+}
 
 RESOURCES += \
     html.qrc \
@@ -0,0 +1,149 @@
+#include "bridgemonitor.h"
+#include <string.h>
+
+const int BridgeMonitor::StallMilliseconds;
+const int BridgeMonitor::MaxStalls;
+
+BridgeMonitor::BridgeMonitor()
+{
+}
+
+BridgeMonitor *BridgeMonitor::instance()
+{
+    static BridgeMonitor *bridgeMonitor = new BridgeMonitor();
+    return bridgeMonitor;
+}
+
+void BridgeMonitor::record(const char *callSite, qint64 nanoseconds, qint64 payloadBytes)
+{
+    QByteArray key = QByteArray::fromRawData(callSite, qstrlen(callSite));
+    QHash<QByteArray, BridgeCallStats>::iterator it = callStats.find(key);
+    if(it == callStats.end())
+    {
+        BridgeCallStats stats;
+        memset(&stats, 0, sizeof(stats));
+        it = callStats.insert(QByteArray(callSite), stats); //deep copy, the key outlives callSite
+    }
+    it->count++;
+    it->totalNanoseconds += nanoseconds;
+    it->maxNanoseconds = qMax(it->maxNanoseconds, nanoseconds);
+    it->payloadBytes += payloadBytes;
+    int bucket = 0;
+    for(qint64 microseconds = nanoseconds / 1000; microseconds > 1 && bucket < 31; microseconds >>= 1)
+    {
+        bucket++;
+    }
+    it->buckets[bucket]++;
+    double milliseconds = nanoseconds / 1000000.0;
+    if(milliseconds > StallMilliseconds)
+    {
+        BridgeStall stall;
+        stall.callSite = it.key();
+        stall.milliseconds = milliseconds;
+        stall.time = QTime::currentTime();
+        stalls.prepend(stall);
+        if(stalls.count() > MaxStalls)
+        {
+            stalls.removeLast();
+        }
+        emit stalled(QString(it.key()), milliseconds);
+    }
+}
+
+//upper bound of the bucket holding the percentile, in milliseconds
+double BridgeMonitor::percentile(const BridgeCallStats &stats, double fraction)
+{
+    qint64 rank = (qint64)(stats.count * fraction);
+    qint64 seen = 0;
+    for(int i = 0; i < 32; i++)
+    {
+        seen += stats.buckets[i];
+        if(seen > rank)
+        {
+            return ((qint64)2 << i) / 1000.0;
+        }
+    }
+    return stats.maxNanoseconds / 1000000.0;
+}
+
+QStringList BridgeMonitor::summary() const
+{
+    //slowest call sites first, by total time spent
+    QMultiMap<qint64, QString> lines;
+    for(QHash<QByteArray, BridgeCallStats>::const_iterator it = callStats.constBegin(); it != callStats.constEnd(); ++it)
+    {
+        const BridgeCallStats &stats = it.value();
+        lines.insert(-stats.totalNanoseconds, QString("%1 n=%2 p50<%3 p95<%4 max=%5 ms, %6 B/call")
+                     .arg(QString(it.key()), -24)
+                     .arg(stats.count)
+                     .arg(percentile(stats, 0.5), 0, 'f', 2)
+                     .arg(percentile(stats, 0.95), 0, 'f', 2)
+                     .arg(stats.maxNanoseconds / 1000000.0, 0, 'f', 1)
+                     .arg(stats.payloadBytes / stats.count));
+    }
+    return lines.values();
+}
+
+QList<BridgeStall> BridgeMonitor::recentStalls() const
+{
+    return stalls;
+}
+
+BridgeTimer::BridgeTimer(const char *callSite, qint64 payloadBytes)
+{
+    this->callSite = callSite;
+    this->payloadBytes = payloadBytes;
+    elapsedTimer.start();
+}
+
+BridgeTimer::~BridgeTimer()
+{
+    BridgeMonitor::instance()->record(callSite, elapsedTimer.nsecsElapsed(), payloadBytes);
+}
+
+void BridgeTimer::addPayload(qint64 bytes)
+{
+    payloadBytes += bytes;
+}
+
+BridgeHud::BridgeHud(QWidget *parent) : QLabel(parent)
+{
+    this->setAttribute(Qt::WA_TransparentForMouseEvents);
+    this->setStyleSheet("background: rgba(0, 0, 0, 180); color: #a6e22e; padding: 6px; font-family: monospace; font-size: 11px;");
+    this->setAlignment(Qt::AlignLeft | Qt::AlignTop);
+    timer = new QTimer(this);
+    timer->setInterval(500);
+    connect(timer, SIGNAL(timeout()), this, SLOT(refresh()));
+    this->hide();
+}
+
+void BridgeHud::showEvent(QShowEvent *showEvent)
+{
+    QLabel::showEvent(showEvent);
+    refresh();
+    timer->start();
+}
+
+void BridgeHud::refresh()
+{
+    if(!this->isVisible())
+    {
+        timer->stop();
+        return;
+    }
+    QStringList lines;
+    lines << tr("GUI thread stalls > %1 ms").arg(BridgeMonitor::StallMilliseconds);
+    QList<BridgeStall> stalls = BridgeMonitor::instance()->recentStalls();
+    for(int i = 0; i < stalls.count(); i++)
+    {
+        lines << QString("  %1 %2 ms %3").arg(stalls[i].time.toString("hh:mm:ss")).arg(stalls[i].milliseconds, 7, 'f', 1).arg(QString(stalls[i].callSite));
+    }
+    lines << "" << tr("Bridge calls");
+    QStringList summary = BridgeMonitor::instance()->summary();
+    lines += summary.mid(0, 12);
+    this->setText(lines.join("\n"));
+    this->adjustSize();
+    QWidget *parent = this->parentWidget();
+    this->move(parent->width() - this->width() - 16, 64);
+    this->raise();
+}
@@ -0,0 +1,80 @@
+#ifndef BRIDGEMONITOR_H
+#define BRIDGEMONITOR_H
+
+
+#include <QtWidgets>
+
+//latency and payload statistics of one bridge call site, buckets are powers of two in microseconds
+struct BridgeCallStats
+{
+    qint64 count;
+    qint64 totalNanoseconds;
+    qint64 maxNanoseconds;
+    qint64 payloadBytes;
+    int buckets[32];
+};
+
+struct BridgeStall
+{
+    QByteArray callSite;
+    double milliseconds;
+    QTime time;
+};
+
+//collects the time the GUI thread spends in C++ <-> JavaScript calls; recording is a hash lookup
+class BridgeMonitor : public QObject
+{
+    Q_OBJECT
+
+signals:
+    void stalled(QString callSite, double milliseconds);
+
+public:
+    static BridgeMonitor *instance();
+    void record(const char *callSite, qint64 nanoseconds, qint64 payloadBytes);
+    QStringList summary() const;
+    QList<BridgeStall> recentStalls() const;
+    static const int StallMilliseconds = 16;
+    static const int MaxStalls = 16;
+
+private:
+    BridgeMonitor();
+    static double percentile(const BridgeCallStats &stats, double fraction);
+    QHash<QByteArray, BridgeCallStats> callStats;
+    QList<BridgeStall> stalls;
+};
+
+//times its own lifetime and records it under callSite
+class BridgeTimer
+{
+public:
+    BridgeTimer(const char *callSite, qint64 payloadBytes);
+    ~BridgeTimer();
+    void addPayload(qint64 bytes);
+
+private:
+    const char *callSite;
+    qint64 payloadBytes;
+    QElapsedTimer elapsedTimer;
+};
+
+//on-screen overlay with the recent stalls and the slowest call sites
+class BridgeHud : public QLabel
+{
+    Q_OBJECT
+
+public:
+    BridgeHud(QWidget *parent);
+
+protected:
+    void showEvent(QShowEvent *showEvent);
+
+private slots:
+    void refresh();
+
+private:
+    QTimer *timer;
+};
+
+
+#endif // BRIDGEMONITOR_H
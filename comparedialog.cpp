@@ -0,0 +1,58 @@
+#include "comparedialog.h"
+#include "linediff.h"
+
+const int CompareDialog::ContextLines;
+
+CompareDialog::CompareDialog(QString filePath, QStringList savedLines, QStringList currentLines)
+{
+    this->setWindowTitle(tr("Compare with Saved - %1").arg(filePath));
+    this->resize(800, 600);
+    QPlainTextEdit *plainTextEdit = new QPlainTextEdit();
+    plainTextEdit->setReadOnly(true);
+    plainTextEdit->setLineWrapMode(QPlainTextEdit::NoWrap);
+    QFont font("Ubuntu Mono");
+    font.setStyleHint(QFont::TypeWriter);
+    plainTextEdit->setFont(font);
+    QVBoxLayout *layout = new QVBoxLayout();
+    layout->addWidget(plainTextEdit);
+    this->setLayout(layout);
+
+    QTextCharFormat contextFormat;
+    QTextCharFormat removedFormat;
+    removedFormat.setBackground(QColor(0x5a, 0x1e, 0x1e));
+    QTextCharFormat addedFormat;
+    addedFormat.setBackground(QColor(0x1e, 0x4a, 0x1e));
+    QTextCharFormat headerFormat;
+    headerFormat.setForeground(QColor(0x66, 0xd9, 0xef));
+
+    QList<DiffHunk> hunks = LineDiff::diff(savedLines, currentLines);
+    if(hunks.isEmpty())
+    {
+        plainTextEdit->setPlainText(tr("No changes."));
+        return;
+    }
+    QTextCursor cursor(plainTextEdit->document());
+    foreach(const DiffHunk &hunk, hunks)
+    {
+        int contextStart = qMax(0, hunk.oldStart - ContextLines);
+        int contextEnd = qMin(savedLines.count(), hunk.oldStart + hunk.oldCount + ContextLines);
+        cursor.insertText(QString("@@ -%1,%2 +%3,%4 @@\n").arg(hunk.oldStart + 1).arg(hunk.oldCount).arg(hunk.newStart + 1).arg(hunk.newCount), headerFormat);
+        for(int i = contextStart; i < hunk.oldStart; i++)
+        {
+            cursor.insertText("  " + savedLines.at(i) + "\n", contextFormat);
+        }
+        for(int i = hunk.oldStart; i < hunk.oldStart + hunk.oldCount; i++)
+        {
+            cursor.insertText("- " + savedLines.at(i) + "\n", removedFormat);
+        }
+        for(int i = hunk.newStart; i < hunk.newStart + hunk.newCount; i++)
+        {
+            cursor.insertText("+ " + currentLines.at(i) + "\n", addedFormat);
+        }
+        for(int i = hunk.oldStart + hunk.oldCount; i < contextEnd; i++)
+        {
+            cursor.insertText("  " + savedLines.at(i) + "\n", contextFormat);
+        }
+    }
+    plainTextEdit->moveCursor(QTextCursor::Start);
+}
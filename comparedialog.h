@@ -0,0 +1,17 @@
+#ifndef COMPAREDIALOG_H
+#define COMPAREDIALOG_H
+
+
+#include <QtWidgets>
+
+class CompareDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    CompareDialog(QString filePath, QStringList savedLines, QStringList currentLines);
+    static const int ContextLines = 3;
+};
+
+
+#endif // COMPAREDIALOG_H
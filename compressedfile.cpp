@@ -0,0 +1,330 @@
+#include "compressedfile.h"
+#include <string.h>
+#include <zlib.h>
+#ifdef NEOEDITOR_ZSTD
+#include <zstd.h>
+#endif
+
+const qint64 CompressedFile::MaxSize;
+const int DecompressStream::BufferSize;
+const int Decompressor::FirstChunkSize;
+const int Decompressor::ChunkSize;
+
+CompressedFile::Format CompressedFile::format(const QString &filePath)
+{
+    if(filePath.endsWith(".gz"))
+    {
+        return Gzip;
+    }
+    if(filePath.endsWith(".zst"))
+    {
+        return Zstd;
+    }
+    return None;
+}
+
+QString CompressedFile::plainPath(const QString &filePath)
+{
+    switch(format(filePath))
+    {
+        case Gzip:
+            return filePath.left(filePath.length() - 3);
+        case Zstd:
+            return filePath.left(filePath.length() - 4);
+        default:
+            return filePath;
+    }
+}
+
+bool CompressedFile::isSupported(Format format)
+{
+#ifdef NEOEDITOR_ZSTD
+    return true;
+#else
+    return format != Zstd;
+#endif
+}
+
+bool CompressedFile::compress(Format format, const QByteArray &data, QByteArray *compressed)
+{
+    if(format == Gzip)
+    {
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        if(deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        {
+            return false;
+        }
+        compressed->resize(deflateBound(&stream, data.size()));
+        stream.next_in = (Bytef*)data.constData();
+        stream.avail_in = data.size();
+        stream.next_out = (Bytef*)compressed->data();
+        stream.avail_out = compressed->size();
+        int result = deflate(&stream, Z_FINISH);
+        compressed->resize(stream.total_out);
+        deflateEnd(&stream);
+        return result == Z_STREAM_END;
+    }
+#ifdef NEOEDITOR_ZSTD
+    if(format == Zstd)
+    {
+        compressed->resize(ZSTD_compressBound(data.size()));
+        size_t size = ZSTD_compress(compressed->data(), compressed->size(), data.constData(), data.size(), 3);
+        if(ZSTD_isError(size))
+        {
+            return false;
+        }
+        compressed->resize(size);
+        return true;
+    }
+#endif
+    return false;
+}
+
+bool CompressedFile::decompress(const QString &filePath, Format format, QByteArray *data)
+{
+    DecompressStream stream(filePath, format);
+    if(!stream.open())
+    {
+        return false;
+    }
+    QByteArray buffer(DecompressStream::BufferSize, Qt::Uninitialized);
+    qint64 size;
+    while((size = stream.read(buffer.data(), buffer.size())) > 0)
+    {
+        if(data->size() + size > MaxSize)
+        {
+            return false;
+        }
+        data->append(buffer.constData(), size);
+    }
+    return size == 0;
+}
+
+DecompressStream::DecompressStream(const QString &filePath, CompressedFile::Format format) : file(filePath), hash(QCryptographicHash::Sha1)
+{
+    this->format = format;
+    stream = 0;
+    inputEnd = false;
+    streamEnd = false;
+}
+
+DecompressStream::~DecompressStream()
+{
+    if(stream == 0)
+    {
+        return;
+    }
+    if(format == CompressedFile::Gzip)
+    {
+        inflateEnd((z_stream*)stream);
+        delete (z_stream*)stream;
+    }
+#ifdef NEOEDITOR_ZSTD
+    else if(format == CompressedFile::Zstd)
+    {
+        ZSTD_freeDStream((ZSTD_DStream*)stream);
+    }
+#endif
+}
+
+bool DecompressStream::open()
+{
+    if(!CompressedFile::isSupported(format))
+    {
+        error = QObject::tr("NeoEditor was built without zstd support");
+        return false;
+    }
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        error = file.errorString();
+        return false;
+    }
+    if(format == CompressedFile::Gzip)
+    {
+        z_stream *zStream = new z_stream;
+        memset(zStream, 0, sizeof(z_stream));
+        if(inflateInit2(zStream, 16 + MAX_WBITS) != Z_OK)
+        {
+            delete zStream;
+            error = QObject::tr("zlib initialization failed");
+            return false;
+        }
+        stream = zStream;
+    }
+#ifdef NEOEDITOR_ZSTD
+    else if(format == CompressedFile::Zstd)
+    {
+        ZSTD_DStream *zstdStream = ZSTD_createDStream();
+        ZSTD_initDStream(zstdStream);
+        stream = zstdStream;
+    }
+#endif
+    return stream != 0;
+}
+
+//called when all buffered input was consumed
+bool DecompressStream::fill()
+{
+    if(inputEnd)
+    {
+        return false;
+    }
+    input = file.read(BufferSize);
+    if(input.isEmpty())
+    {
+        inputEnd = true;
+        return false;
+    }
+    hash.addData(input);
+    return true;
+}
+
+//decompressed bytes, 0 at the end of the data and -1 on errors
+qint64 DecompressStream::read(char *data, qint64 maxSize)
+{
+    if(stream == 0)
+    {
+        return -1;
+    }
+    if(format == CompressedFile::Gzip)
+    {
+        z_stream *zStream = (z_stream*)stream;
+        zStream->next_out = (Bytef*)data;
+        zStream->avail_out = maxSize;
+        while(zStream->avail_out > 0)
+        {
+            if(zStream->avail_in == 0)
+            {
+                if(!fill())
+                {
+                    break;
+                }
+                zStream->next_in = (Bytef*)input.data();
+                zStream->avail_in = input.size();
+            }
+            int result = inflate(zStream, Z_NO_FLUSH);
+            if(result == Z_STREAM_END)
+            {
+                //rotated logs are often several gzip members concatenated
+                streamEnd = true;
+                inflateReset(zStream);
+                continue;
+            }
+            if(result == Z_BUF_ERROR && zStream->avail_in > 0)
+            {
+                break;
+            }
+            if(result != Z_OK && result != Z_BUF_ERROR)
+            {
+                error = QString::fromLatin1(zStream->msg != 0 ? zStream->msg : "corrupt gzip data");
+                return -1;
+            }
+            streamEnd = false;
+        }
+        qint64 size = maxSize - zStream->avail_out;
+        if(size == 0 && inputEnd && !streamEnd)
+        {
+            error = QObject::tr("unexpected end of gzip data");
+            return -1;
+        }
+        return size;
+    }
+#ifdef NEOEDITOR_ZSTD
+    if(format == CompressedFile::Zstd)
+    {
+        ZSTD_outBuffer out = {data, (size_t)maxSize, 0};
+        while(out.pos < out.size)
+        {
+            if(input.isEmpty() && !fill())
+            {
+                break;
+            }
+            ZSTD_inBuffer in = {input.constData(), (size_t)input.size(), 0};
+            size_t result = ZSTD_decompressStream((ZSTD_DStream*)stream, &out, &in);
+            if(ZSTD_isError(result))
+            {
+                error = QString::fromLatin1(ZSTD_getErrorName(result));
+                return -1;
+            }
+            input = input.mid(in.pos);
+        }
+        return out.pos;
+    }
+#endif
+    return -1;
+}
+
+//hash of the compressed bytes read so far, complete once read() returned 0
+QByteArray DecompressStream::compressedHash()
+{
+    return hash.result();
+}
+
+QString DecompressStream::errorString() const
+{
+    return error;
+}
+
+Decompressor::Decompressor(int id, const QString &filePath, CompressedFile::Format format, QSharedPointer<DecompressState> state)
+{
+    this->id = id;
+    this->filePath = filePath;
+    this->format = format;
+    this->state = state;
+}
+
+void Decompressor::run()
+{
+    DecompressStream stream(filePath, format);
+    if(!stream.open())
+    {
+        emit finished(id, false, false, QByteArray(), stream.errorString());
+        return;
+    }
+    //the first chunk is small so the beginning of the file shows up right away
+    QTextDecoder decoder(QTextCodec::codecForName("UTF-8"));
+    QByteArray buffer(DecompressStream::BufferSize, Qt::Uninitialized);
+    QString text;
+    qint64 total = 0;
+    int threshold = FirstChunkSize;
+    qint64 size;
+    while((size = stream.read(buffer.data(), buffer.size())) > 0)
+    {
+        text += decoder.toUnicode(buffer.constData(), size);
+        total += size;
+        if(text.length() >= threshold || total >= CompressedFile::MaxSize)
+        {
+            state->credits.acquire();
+            if(state->cancelled.load())
+            {
+                return;
+            }
+            //a \r\n pair cut by the chunk boundary would become two line breaks, hold the \r back
+            QString carry;
+            if(text.endsWith(QLatin1Char('\r')) && total < CompressedFile::MaxSize)
+            {
+                carry = QString(QLatin1Char('\r'));
+                text.chop(1);
+            }
+            emit chunk(id, text);
+            text = carry;
+            threshold = ChunkSize;
+        }
+        if(total >= CompressedFile::MaxSize)
+        {
+            emit finished(id, true, true, QByteArray(), QString());
+            return;
+        }
+    }
+    if(!text.isEmpty())
+    {
+        state->credits.acquire();
+        if(state->cancelled.load())
+        {
+            return;
+        }
+        emit chunk(id, text);
+    }
+    emit finished(id, size == 0, false, stream.compressedHash(), stream.errorString());
+}
@@ -0,0 +1,80 @@
+#ifndef COMPRESSEDFILE_H
+#define COMPRESSEDFILE_H
+
+
+#include <QtCore>
+
+//gzip (zlib) is always available, zstd only when built with NEOEDITOR_ZSTD
+class CompressedFile
+{
+public:
+    enum Format
+    {
+        None,
+        Gzip,
+        Zstd
+    };
+    static Format format(const QString &filePath);
+    static QString plainPath(const QString &filePath);
+    static bool isSupported(Format format);
+    static bool compress(Format format, const QByteArray &data, QByteArray *compressed);
+    static bool decompress(const QString &filePath, Format format, QByteArray *data);
+    static const qint64 MaxSize = 512 * 1024 * 1024;
+};
+
+//pulls decompressed bytes out of a compressed file, only a few buffers are held in memory
+class DecompressStream
+{
+public:
+    DecompressStream(const QString &filePath, CompressedFile::Format format);
+    ~DecompressStream();
+    bool open();
+    qint64 read(char *data, qint64 maxSize);
+    QByteArray compressedHash();
+    QString errorString() const;
+    static const int BufferSize = 256 * 1024;
+
+private:
+    bool fill();
+    QFile file;
+    CompressedFile::Format format;
+    QByteArray input;
+    QCryptographicHash hash;
+    void *stream;
+    bool inputEnd;
+    bool streamEnd;
+    QString error;
+};
+
+//shared by a WebView and its decompressor; the decompressor waits for credits so a slow
+//editor bounds the number of decoded chunks in flight
+struct DecompressState
+{
+    DecompressState() : credits(8) {}
+    QSemaphore credits;
+    QAtomicInt cancelled;
+};
+
+class Decompressor : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+signals:
+    void chunk(int id, QString text);
+    void finished(int id, bool ok, bool truncated, QByteArray compressedHash, QString error);
+
+public:
+    Decompressor(int id, const QString &filePath, CompressedFile::Format format, QSharedPointer<DecompressState> state);
+    void run();
+    static const int FirstChunkSize = 64 * 1024;
+    static const int ChunkSize = 1024 * 1024;
+
+private:
+    int id;
+    QString filePath;
+    CompressedFile::Format format;
+    QSharedPointer<DecompressState> state;
+};
+
+
+#endif // COMPRESSEDFILE_H
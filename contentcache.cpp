@@ -0,0 +1,146 @@
+#include "contentcache.h"
+#include "compressedfile.h"
+
+const int ContentCache::BudgetBytes;
+const int ContentCache::MaxFileBytes;
+
+ContentCache *ContentCache::instance()
+{
+    static ContentCache *contentCache = new ContentCache();
+    return contentCache;
+}
+
+ContentCache::ContentCache()
+{
+    cache.setMaxCost(BudgetBytes);
+    fileSystemWatcher = new QFileSystemWatcher(this);
+    connect(fileSystemWatcher, SIGNAL(fileChanged(QString)), this, SLOT(fileChanged(QString)));
+}
+
+//only plain text files that WebView opens itself and that are small enough to be worth keeping
+bool ContentCache::isCacheable(const QFileInfo &fileInfo)
+{
+    QString suffix = fileInfo.suffix().toLower();
+    return fileInfo.isFile() && fileInfo.size() <= MaxFileBytes
+            && CompressedFile::format(fileInfo.filePath()) == CompressedFile::None
+            && suffix != "csv" && suffix != "tsv";
+}
+
+//the entry is handed to the opening editor and dropped from the cache, a hit still has to match the file's size and time
+bool ContentCache::take(const QString &filePath, CachedContent *cachedContent)
+{
+    CachedContent *entry = cache.object(filePath);
+    if(entry == 0)
+    {
+        return false;
+    }
+    QFileInfo fileInfo(filePath);
+    bool fresh = fileInfo.size() == entry->size && fileInfo.lastModified() == entry->lastModified;
+    if(fresh)
+    {
+        *cachedContent = *entry;
+    }
+    invalidate(filePath);
+    return fresh;
+}
+
+void ContentCache::prefetch(const QString &filePath)
+{
+    if(pending.contains(filePath) || cache.contains(filePath))
+    {
+        return;
+    }
+    if(!isCacheable(QFileInfo(filePath)))
+    {
+        return;
+    }
+    pending.insert(filePath);
+    Prefetcher *prefetcher = new Prefetcher(filePath);
+    connect(prefetcher, SIGNAL(loaded(QString, QString, QByteArray, qint64, QDateTime)), this, SLOT(loaded(QString, QString, QByteArray, qint64, QDateTime)));
+    QThreadPool::globalInstance()->start(prefetcher, -1); //behind any work the user is waiting for
+}
+
+//text of a closed tab, kept only when it is exactly what is on disk
+void ContentCache::insert(const QString &filePath, const QString &content, const QByteArray &hash)
+{
+    QFileInfo fileInfo(filePath);
+    if(!isCacheable(fileInfo) || QCryptographicHash::hash(content.toUtf8(), QCryptographicHash::Sha1) != hash)
+    {
+        return;
+    }
+    CachedContent *cachedContent = new CachedContent();
+    cachedContent->content = content;
+    cachedContent->hash = hash;
+    cachedContent->size = fileInfo.size();
+    cachedContent->lastModified = fileInfo.lastModified();
+    store(filePath, cachedContent);
+}
+
+void ContentCache::invalidate(const QString &filePath)
+{
+    cache.remove(filePath);
+    fileSystemWatcher->removePath(filePath);
+}
+
+void ContentCache::loaded(QString filePath, QString content, QByteArray hash, qint64 size, QDateTime lastModified)
+{
+    if(!pending.remove(filePath) || hash.isNull())
+    {
+        return; //invalidated while loading, or unreadable
+    }
+    CachedContent *cachedContent = new CachedContent();
+    cachedContent->content = content;
+    cachedContent->hash = hash;
+    cachedContent->size = size;
+    cachedContent->lastModified = lastModified;
+    store(filePath, cachedContent);
+}
+
+void ContentCache::store(const QString &filePath, CachedContent *cachedContent)
+{
+    cache.insert(filePath, cachedContent, qMax(1, cachedContent->content.length() * (int)sizeof(QChar)));
+    //entries evicted by the insert are not watched any more
+    foreach(const QString &watchedPath, fileSystemWatcher->files())
+    {
+        if(!cache.contains(watchedPath))
+        {
+            fileSystemWatcher->removePath(watchedPath);
+        }
+    }
+    if(cache.contains(filePath))
+    {
+        fileSystemWatcher->addPath(filePath);
+    }
+}
+
+void ContentCache::fileChanged(QString filePath)
+{
+    pending.remove(filePath);
+    invalidate(filePath);
+}
+
+Prefetcher::Prefetcher(const QString &filePath)
+{
+    this->filePath = filePath;
+}
+
+void Prefetcher::run()
+{
+    QFile file(filePath);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        emit loaded(filePath, QString(), QByteArray(), 0, QDateTime());
+        return;
+    }
+    QFileInfo fileInfo(file);
+    qint64 size = fileInfo.size();
+    QDateTime lastModified = fileInfo.lastModified();
+    QByteArray data = file.readAll();
+    file.close();
+    if(data.size() != size)
+    {
+        emit loaded(filePath, QString(), QByteArray(), 0, QDateTime()); //written while reading
+        return;
+    }
+    emit loaded(filePath, QString(data), QCryptographicHash::hash(data, QCryptographicHash::Sha1), size, lastModified);
+}
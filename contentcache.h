@@ -0,0 +1,60 @@
+#ifndef CONTENTCACHE_H
+#define CONTENTCACHE_H
+
+
+#include <QtCore>
+
+//decoded text of a file as WebView::init would produce it, with the hash of the bytes on disk
+struct CachedContent
+{
+    QString content;
+    QByteArray hash;
+    qint64 size;
+    QDateTime lastModified;
+};
+
+//files that are likely to be opened next, read and decoded ahead of time;
+//least recently used entries are dropped beyond the memory budget
+class ContentCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    static ContentCache *instance();
+    bool take(const QString &filePath, CachedContent *cachedContent);
+    void prefetch(const QString &filePath);
+    void insert(const QString &filePath, const QString &content, const QByteArray &hash);
+    void invalidate(const QString &filePath);
+    static const int BudgetBytes = 64 * 1024 * 1024;
+    static const int MaxFileBytes = 4 * 1024 * 1024;
+
+private slots:
+    void loaded(QString filePath, QString content, QByteArray hash, qint64 size, QDateTime lastModified);
+    void fileChanged(QString filePath);
+
+private:
+    ContentCache();
+    bool isCacheable(const QFileInfo &fileInfo);
+    void store(const QString &filePath, CachedContent *cachedContent);
+    QCache<QString, CachedContent> cache;
+    QSet<QString> pending;
+    QFileSystemWatcher *fileSystemWatcher;
+};
+
+class Prefetcher : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+signals:
+    void loaded(QString filePath, QString content, QByteArray hash, qint64 size, QDateTime lastModified);
+
+public:
+    Prefetcher(const QString &filePath);
+    void run();
+
+private:
+    QString filePath;
+};
+
+
+#endif // CONTENTCACHE_H
@@ -0,0 +1,583 @@
+#include "csvview.h"
+#include <string.h>
+#include <algorithm>
+
+const qint64 CsvModel::ChunkSize;
+const int CsvView::ReloadDelay;
+
+CsvFile::CsvFile(const QString &filePath)
+{
+    this->filePath = filePath;
+    this->data = 0;
+    this->size = 0;
+    this->delimiter = QFileInfo(filePath).suffix().toLower() == "tsv" ? '\t' : ',';
+}
+
+CsvFile::~CsvFile()
+{
+    if(size > 0)
+    {
+        file.unmap((uchar*)data);
+    }
+    file.close();
+}
+
+bool CsvFile::open()
+{
+    file.setFileName(filePath);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+    size = file.size();
+    if(size == 0)
+    {
+        data = "";
+        return true;
+    }
+    data = (const char*)file.map(0, size);
+    if(data == 0)
+    {
+        size = 0;
+        return false;
+    }
+    return true;
+}
+
+//RFC 4180 fields of the record [start, end), stops after lastColumn unless it is -1
+QStringList CsvFile::fields(qint64 start, qint64 end, int lastColumn) const
+{
+    if(start == 0 && end >= 3 && memcmp(data, "\xEF\xBB\xBF", 3) == 0)
+    {
+        start = 3;
+    }
+    if(end > start && data[end - 1] == '\r')
+    {
+        end--;
+    }
+    QStringList fields;
+    QByteArray field;
+    bool quoted = false;
+    for(qint64 i = start; i < end; i++)
+    {
+        char c = data[i];
+        if(quoted)
+        {
+            if(c != '"')
+            {
+                field += c;
+            }
+            else if(i + 1 < end && data[i + 1] == '"')
+            {
+                field += '"';
+                i++;
+            }
+            else
+            {
+                quoted = false;
+            }
+        }
+        else if(c == '"')
+        {
+            quoted = true;
+        }
+        else if(c == delimiter)
+        {
+            fields << QString::fromUtf8(field);
+            field.clear();
+            if(fields.count() > lastColumn && lastColumn != -1)
+            {
+                return fields;
+            }
+        }
+        else
+        {
+            field += c;
+        }
+    }
+    fields << QString::fromUtf8(field);
+    return fields;
+}
+
+CsvChunkScanner::CsvChunkScanner(CsvFilePointer csvFile, int chunk, qint64 start, qint64 end)
+{
+    this->csvFile = csvFile;
+    this->chunk = chunk;
+    this->start = start;
+    this->end = end;
+}
+
+void CsvChunkScanner::run()
+{
+    if(csvFile->cancelled.load())
+    {
+        return;
+    }
+    CsvChunkPointer csvChunk(new CsvChunk());
+    csvChunk->quotes = 0;
+    const char *data = csvFile->data;
+    const char *limit = data + end;
+    const char *quote = (const char*)memchr(data + start, '"', end - start);
+    const char *newline = (const char*)memchr(data + start, '\n', end - start);
+    bool odd = false;
+    int count = 0;
+    while(newline != 0)
+    {
+        while(quote != 0 && quote < newline)
+        {
+            odd = !odd;
+            csvChunk->quotes++;
+            quote = (const char*)memchr(quote + 1, '"', limit - quote - 1);
+        }
+        if(odd)
+        {
+            csvChunk->oddBreaks.append(newline - data);
+        }
+        else
+        {
+            csvChunk->evenBreaks.append(newline - data);
+        }
+        if((++count & 0xffff) == 0 && csvFile->cancelled.load())
+        {
+            return;
+        }
+        newline = (const char*)memchr(newline + 1, '\n', limit - newline - 1);
+    }
+    while(quote != 0)
+    {
+        csvChunk->quotes++;
+        quote = (const char*)memchr(quote + 1, '"', limit - quote - 1);
+    }
+    emit scanned(chunk, csvChunk);
+}
+
+struct CsvNumberLessThan
+{
+    CsvNumberLessThan(const QVector<double> &keys, bool descending) : keys(keys), descending(descending) {}
+    bool operator()(int a, int b) const
+    {
+        return descending ? keys.at(b) < keys.at(a) : keys.at(a) < keys.at(b);
+    }
+    const QVector<double> &keys;
+    bool descending;
+};
+
+struct CsvTextLessThan
+{
+    CsvTextLessThan(const QVector<QString> &keys, bool descending) : keys(keys), descending(descending) {}
+    bool operator()(int a, int b) const
+    {
+        int result = descending ? keys.at(b).compare(keys.at(a), Qt::CaseInsensitive) : keys.at(a).compare(keys.at(b), Qt::CaseInsensitive);
+        return result < 0;
+    }
+    const QVector<QString> &keys;
+    bool descending;
+};
+
+CsvQuery::CsvQuery(CsvFilePointer csvFile, int generation, const QVector<qint64> &recordOffsets, const QString &filter, int sortColumn, Qt::SortOrder sortOrder)
+{
+    this->csvFile = csvFile;
+    this->generation = generation;
+    this->recordOffsets = recordOffsets;
+    this->filter = filter;
+    this->sortColumn = sortColumn;
+    this->sortOrder = sortOrder;
+}
+
+bool CsvQuery::isCancelled()
+{
+    return csvFile->cancelled.load() || csvFile->queryGeneration.load() != generation;
+}
+
+void CsvQuery::run()
+{
+    const char *data = csvFile->data;
+    int records = recordOffsets.count() - 1;
+    QVector<int> rows;
+    //the filter matches the raw record text, so rows are never split just to be filtered
+    QByteArrayMatcher matcher(filter.toUtf8());
+    for(int record = 1; record < records; record++)
+    {
+        if((record & 0xffff) == 0 && isCancelled())
+        {
+            return;
+        }
+        if(!filter.isEmpty())
+        {
+            qint64 start = recordOffsets.at(record);
+            qint64 end = recordOffsets.at(record + 1) - 1;
+            if(matcher.indexIn(data + start, end - start) == -1)
+            {
+                continue;
+            }
+        }
+        rows << record - 1;
+    }
+
+    if(sortColumn >= 0)
+    {
+        QVector<QString> keys(rows.count());
+        for(int i = 0; i < rows.count(); i++)
+        {
+            if((i & 0xffff) == 0 && isCancelled())
+            {
+                return;
+            }
+            int record = rows.at(i) + 1;
+            keys[i] = csvFile->fields(recordOffsets.at(record), recordOffsets.at(record + 1) - 1, sortColumn).value(sortColumn);
+        }
+        //numbers are compared as numbers when every non-empty key is one
+        QVector<double> numbers(rows.count());
+        bool numeric = true;
+        for(int i = 0; i < keys.count() && numeric; i++)
+        {
+            bool ok = true;
+            numbers[i] = keys.at(i).isEmpty() ? -1e308 : keys.at(i).toDouble(&ok);
+            numeric = ok;
+        }
+        QVector<int> permutation(rows.count());
+        for(int i = 0; i < permutation.count(); i++)
+        {
+            permutation[i] = i;
+        }
+        if(numeric)
+        {
+            std::stable_sort(permutation.begin(), permutation.end(), CsvNumberLessThan(numbers, sortOrder == Qt::DescendingOrder));
+        }
+        else
+        {
+            std::stable_sort(permutation.begin(), permutation.end(), CsvTextLessThan(keys, sortOrder == Qt::DescendingOrder));
+        }
+        QVector<int> sortedRows(rows.count());
+        for(int i = 0; i < permutation.count(); i++)
+        {
+            sortedRows[i] = rows.at(permutation.at(i));
+        }
+        rows = sortedRows;
+    }
+    if(!isCancelled())
+    {
+        emit finished(generation, rows);
+    }
+}
+
+CsvModel::CsvModel(QObject *parent, const QString &filePath) : QAbstractTableModel(parent)
+{
+    this->csvFile = CsvFilePointer(new CsvFile(filePath));
+    this->nextChunk = 0;
+    this->chunkCount = 0;
+    this->quoted = false;
+    this->querying = false;
+    this->queryActive = false;
+    this->sortColumn = -1;
+    this->sortOrder = Qt::AscendingOrder;
+    this->recordCache.setMaxCost(4096);
+    this->scanPool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+    this->queryPool.setMaxThreadCount(1);
+    qRegisterMetaType<CsvChunkPointer>("CsvChunkPointer");
+    qRegisterMetaType<QVector<int> >("QVector<int>");
+}
+
+CsvModel::~CsvModel()
+{
+    close();
+}
+
+//stops the workers and waits for them, after which nothing but this model reads the mapping
+void CsvModel::close()
+{
+    csvFile->cancelled.store(1);
+    scanPool.clear();
+    scanPool.waitForDone();
+    queryPool.clear();
+    queryPool.waitForDone();
+}
+
+bool CsvModel::open()
+{
+    if(!csvFile->open())
+    {
+        return false;
+    }
+    indexTimer.start();
+    recordOffsets << 0;
+    chunkCount = (int)((csvFile->size + ChunkSize - 1) / ChunkSize);
+    //chunks are queued in order, so the first page is indexed before the rest of the file
+    for(int chunk = 0; chunk < chunkCount; chunk++)
+    {
+        qint64 start = chunk * ChunkSize;
+        CsvChunkScanner *csvChunkScanner = new CsvChunkScanner(csvFile, chunk, start, qMin(start + ChunkSize, csvFile->size));
+        connect(csvChunkScanner, SIGNAL(scanned(int, CsvChunkPointer)), this, SLOT(chunkScanned(int, CsvChunkPointer)));
+        scanPool.start(csvChunkScanner);
+    }
+    updateStatus();
+    return true;
+}
+
+void CsvModel::chunkScanned(int chunk, CsvChunkPointer csvChunk)
+{
+    pendingChunks.insert(chunk, csvChunk);
+    QVector<qint64> added;
+    while(pendingChunks.contains(nextChunk))
+    {
+        CsvChunkPointer next = pendingChunks.take(nextChunk);
+        const QVector<qint64> &breaks = quoted ? next->oddBreaks : next->evenBreaks;
+        for(int i = 0; i < breaks.count(); i++)
+        {
+            added << breaks.at(i) + 1;
+        }
+        if(next->quotes % 2 == 1)
+        {
+            quoted = !quoted;
+        }
+        nextChunk++;
+    }
+    bool finished = nextChunk == chunkCount;
+    qint64 last = added.isEmpty() ? recordOffsets.last() : added.last();
+    if(finished && last < csvFile->size)
+    {
+        added << csvFile->size + 1; //the last record has no line break
+    }
+    if(!added.isEmpty())
+    {
+        if(header.isEmpty())
+        {
+            QStringList fields = csvFile->fields(0, added.first() - 1);
+            beginInsertColumns(QModelIndex(), 0, fields.count() - 1);
+            header = fields;
+            endInsertColumns();
+        }
+        int oldRows = rowCount();
+        int newRows = qMax(0, recordOffsets.count() + added.count() - 2);
+        if(!queryActive && newRows > oldRows)
+        {
+            beginInsertRows(QModelIndex(), oldRows, newRows - 1);
+            recordOffsets += added;
+            endInsertRows();
+        }
+        else
+        {
+            recordOffsets += added;
+        }
+    }
+    if(finished && queryActive)
+    {
+        startQuery(); //the previous result only covered the records indexed so far
+    }
+    updateStatus();
+}
+
+int CsvModel::recordCount() const
+{
+    return recordOffsets.count() - 1;
+}
+
+int CsvModel::rowCount(const QModelIndex &parent) const
+{
+    if(parent.isValid())
+    {
+        return 0;
+    }
+    if(queryActive)
+    {
+        return rows.count();
+    }
+    return qMax(0, recordCount() - 1);
+}
+
+int CsvModel::columnCount(const QModelIndex &parent) const
+{
+    if(parent.isValid())
+    {
+        return 0;
+    }
+    return header.count();
+}
+
+const QStringList &CsvModel::record(int record) const
+{
+    QStringList *fields = recordCache.object(record);
+    if(fields == 0)
+    {
+        fields = new QStringList(csvFile->fields(recordOffsets.at(record), recordOffsets.at(record + 1) - 1));
+        recordCache.insert(record, fields);
+    }
+    return *fields;
+}
+
+QVariant CsvModel::data(const QModelIndex &index, int role) const
+{
+    if(!index.isValid() || (role != Qt::DisplayRole && role != Qt::ToolTipRole))
+    {
+        return QVariant();
+    }
+    int row = queryActive ? rows.at(index.row()) : index.row();
+    return record(row + 1).value(index.column());
+}
+
+QVariant CsvModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if(role != Qt::DisplayRole)
+    {
+        return QVariant();
+    }
+    if(orientation == Qt::Horizontal)
+    {
+        return header.value(section);
+    }
+    //numbered by position in the file, also when sorted or filtered
+    return (queryActive ? rows.at(section) : section) + 1;
+}
+
+void CsvModel::sort(int column, Qt::SortOrder order)
+{
+    sortColumn = column;
+    sortOrder = order;
+    startQuery();
+}
+
+void CsvModel::setFilter(const QString &filter)
+{
+    this->filter = filter;
+    startQuery();
+}
+
+void CsvModel::startQuery()
+{
+    int generation = csvFile->queryGeneration.fetchAndAddOrdered(1) + 1;
+    if(filter.isEmpty() && sortColumn < 0)
+    {
+        querying = false;
+        if(queryActive)
+        {
+            beginResetModel();
+            queryActive = false;
+            rows.clear();
+            endResetModel();
+        }
+        updateStatus();
+        return;
+    }
+    querying = true;
+    CsvQuery *csvQuery = new CsvQuery(csvFile, generation, recordOffsets, filter, sortColumn, sortOrder);
+    connect(csvQuery, SIGNAL(finished(int, QVector<int>)), this, SLOT(queryFinished(int, QVector<int>)));
+    queryPool.clear(); //a query still waiting is already outdated
+    queryPool.start(csvQuery);
+    updateStatus();
+}
+
+void CsvModel::queryFinished(int generation, QVector<int> rows)
+{
+    if(generation != csvFile->queryGeneration.load())
+    {
+        return;
+    }
+    beginResetModel();
+    this->rows = rows;
+    queryActive = true;
+    endResetModel();
+    querying = false;
+    updateStatus();
+}
+
+void CsvModel::updateStatus()
+{
+    int records = qMax(0, recordCount() - 1);
+    QString status;
+    if(nextChunk < chunkCount)
+    {
+        status = tr("Indexing... %L1 rows (%2%)").arg(records).arg(nextChunk * 100 / chunkCount);
+    }
+    else
+    {
+        status = tr("%L1 rows, indexed in %2 s").arg(records).arg(indexTimer.elapsed() / 1000.0, 0, 'f', 1);
+    }
+    if(querying)
+    {
+        status += tr(", sorting and filtering...");
+    }
+    else if(queryActive && !filter.isEmpty())
+    {
+        status += tr(", %L1 matching").arg(rows.count());
+    }
+    emit statusChanged(status);
+}
+
+CsvView::CsvView(QWidget *parent, const QString &filePath) : QWidget(parent)
+{
+    this->mFilePath = filePath;
+    filterEdit = new QLineEdit();
+    filterEdit->setPlaceholderText(tr("Filter rows"));
+    filterTimer = new QTimer(this);
+    filterTimer->setSingleShot(true);
+    filterTimer->setInterval(300);
+    connect(filterEdit, SIGNAL(textChanged(QString)), filterTimer, SLOT(start()));
+    connect(filterTimer, SIGNAL(timeout()), this, SLOT(filter()));
+    //a file still being written fires fileChanged over and over
+    reloadTimer = new QTimer(this);
+    reloadTimer->setSingleShot(true);
+    reloadTimer->setInterval(ReloadDelay);
+    connect(reloadTimer, SIGNAL(timeout()), this, SLOT(load()));
+    statusLabel = new QLabel();
+
+    tableView = new QTableView();
+    tableView->setWordWrap(false);
+    //fixed row heights, so the view never measures millions of rows
+    tableView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    tableView->verticalHeader()->setDefaultSectionSize(tableView->fontMetrics().height() + 4);
+    tableView->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+    csvModel = 0;
+    load();
+    tableView->setSortingEnabled(true);
+
+    QHBoxLayout *filterLayout = new QHBoxLayout();
+    filterLayout->addWidget(filterEdit);
+    filterLayout->addWidget(statusLabel);
+    QVBoxLayout *layout = new QVBoxLayout();
+    layout->addLayout(filterLayout);
+    layout->addWidget(tableView);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->setSpacing(0);
+    this->setLayout(layout);
+}
+
+QString CsvView::filePath()
+{
+    return mFilePath;
+}
+
+void CsvView::reload()
+{
+    reloadTimer->start();
+}
+
+void CsvView::load()
+{
+    CsvModel *oldModel = csvModel;
+    if(oldModel != 0)
+    {
+        //the old mapping may cover bytes the file no longer has, no worker may touch it from here on
+        oldModel->close();
+    }
+    csvModel = new CsvModel(this, mFilePath);
+    connect(csvModel, SIGNAL(statusChanged(QString)), statusLabel, SLOT(setText(QString)));
+    if(!csvModel->open())
+    {
+        statusLabel->setText(tr("Failed to open %1").arg(mFilePath));
+    }
+    tableView->setModel(csvModel);
+    tableView->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+    if(!filterEdit->text().isEmpty())
+    {
+        csvModel->setFilter(filterEdit->text());
+    }
+    if(oldModel != 0)
+    {
+        oldModel->deleteLater();
+    }
+}
+
+void CsvView::filter()
+{
+    csvModel->setFilter(filterEdit->text());
+}
@@ -0,0 +1,156 @@
+#ifndef CSVVIEW_H
+#define CSVVIEW_H
+
+
+#include <QtWidgets>
+
+//a memory mapped CSV/TSV file, shared with the workers that index, sort and filter it
+class CsvFile
+{
+public:
+    CsvFile(const QString &filePath);
+    ~CsvFile();
+    bool open();
+    QStringList fields(qint64 start, qint64 end, int lastColumn = -1) const;
+    QString filePath;
+    const char *data;
+    qint64 size;
+    char delimiter;
+    QAtomicInt cancelled;
+    QAtomicInt queryGeneration;
+
+private:
+    QFile file;
+};
+
+typedef QSharedPointer<CsvFile> CsvFilePointer;
+
+//record breaks of one chunk for both possible quote states at its start, since that
+//state is only known once every chunk before it has been scanned
+struct CsvChunk
+{
+    int quotes;
+    QVector<qint64> evenBreaks;
+    QVector<qint64> oddBreaks;
+};
+
+typedef QSharedPointer<CsvChunk> CsvChunkPointer;
+Q_DECLARE_METATYPE(CsvChunkPointer)
+
+class CsvChunkScanner : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+signals:
+    void scanned(int chunk, CsvChunkPointer csvChunk);
+
+public:
+    CsvChunkScanner(CsvFilePointer csvFile, int chunk, qint64 start, qint64 end);
+    void run();
+
+private:
+    CsvFilePointer csvFile;
+    int chunk;
+    qint64 start;
+    qint64 end;
+};
+
+//filter and sort over a snapshot of the record index, results are source rows in display order
+class CsvQuery : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+signals:
+    void finished(int generation, QVector<int> rows);
+
+public:
+    CsvQuery(CsvFilePointer csvFile, int generation, const QVector<qint64> &recordOffsets, const QString &filter, int sortColumn, Qt::SortOrder sortOrder);
+    void run();
+
+private:
+    bool isCancelled();
+    CsvFilePointer csvFile;
+    int generation;
+    QVector<qint64> recordOffsets;
+    QString filter;
+    int sortColumn;
+    Qt::SortOrder sortOrder;
+};
+
+class CsvModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+signals:
+    void statusChanged(QString status);
+
+public:
+    CsvModel(QObject *parent, const QString &filePath);
+    ~CsvModel();
+    bool open();
+    void close();
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder);
+    void setFilter(const QString &filter);
+    static const qint64 ChunkSize = 16 * 1024 * 1024;
+
+private slots:
+    void chunkScanned(int chunk, CsvChunkPointer csvChunk);
+    void queryFinished(int generation, QVector<int> rows);
+
+private:
+    void startQuery();
+    void updateStatus();
+    int recordCount() const;
+    const QStringList &record(int record) const;
+    CsvFilePointer csvFile;
+    QVector<qint64> recordOffsets; //start of every record, the header included
+    QStringList header;
+    QHash<int, CsvChunkPointer> pendingChunks;
+    int nextChunk;
+    int chunkCount;
+    bool quoted;
+    QElapsedTimer indexTimer;
+    QVector<int> rows;
+    bool querying;
+    bool queryActive;
+    QString filter;
+    int sortColumn;
+    Qt::SortOrder sortOrder;
+    mutable QCache<int, QStringList> recordCache;
+    //private pools: the scanners of a large file can't starve the global pool, queries don't wait
+    //behind the scan, and close() can wait for exactly the workers reading the mapping
+    QThreadPool scanPool;
+    QThreadPool queryPool;
+};
+
+//read-only table for large CSV/TSV files, only the visible rows are ever split into columns
+class CsvView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    CsvView(QWidget *parent, const QString &filePath);
+    QString filePath();
+    void reload();
+    static const int ReloadDelay = 500;
+
+private slots:
+    void load();
+    void filter();
+
+private:
+    QString mFilePath;
+    CsvModel *csvModel;
+    QTableView *tableView;
+    QLineEdit *filterEdit;
+    QLabel *statusLabel;
+    QTimer *filterTimer;
+    QTimer *reloadTimer;
+};
+
+
+#endif // CSVVIEW_H
@@ -0,0 +1,185 @@
+#include "documentsearch.h"
+
+const int DocumentSearcher::MaxOccurrences;
+
+//a literal query that extends the previous one can only match where the previous one did
+bool SearchResult::canRefine(const SearchQuery &query) const
+{
+    return !truncated && error.isNull() && !this->query.regularExpression && !query.regularExpression
+            && this->query.caseSensitive == query.caseSensitive && !this->query.text.isEmpty()
+            && query.text.startsWith(this->query.text, query.caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive);
+}
+
+//first match on or after row
+int SearchResult::lowerBound(int row) const
+{
+    int low = 0;
+    int high = matches.count();
+    while(low < high)
+    {
+        int middle = (low + high) / 2;
+        if(rows.at(matches.at(middle)) < row)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+int SearchResult::firstMatchAfter(int row, int column) const
+{
+    if(matches.isEmpty())
+    {
+        return -1;
+    }
+    for(int i = lowerBound(row); i < matches.count(); i++)
+    {
+        int occurrence = matches.at(i);
+        if(rows.at(occurrence) > row || columns.at(occurrence) >= column)
+        {
+            return i;
+        }
+    }
+    return 0; //wrap around
+}
+
+DocumentSearcher::DocumentSearcher(int generation, QSharedPointer<QAtomicInt> currentGeneration, const QStringList &lines, const SearchQuery &query, SearchResultPointer previous)
+{
+    this->generation = generation;
+    this->currentGeneration = currentGeneration;
+    this->lines = lines;
+    this->query = query;
+    this->previous = previous;
+    qRegisterMetaType<SearchResultPointer>("SearchResultPointer");
+}
+
+bool DocumentSearcher::isCancelled()
+{
+    return currentGeneration->load() != generation;
+}
+
+void DocumentSearcher::run()
+{
+    result = SearchResultPointer(new SearchResult());
+    result->query = query;
+    result->truncated = false;
+    if(query.regularExpression)
+    {
+        searchRegularExpression();
+    }
+    else if(!previous.isNull() && previous->canRefine(query))
+    {
+        refineLiteral();
+    }
+    else
+    {
+        searchLiteral();
+    }
+    if(isCancelled())
+    {
+        return;
+    }
+    //overlapping occurrences are kept for refinement but only highlighted once
+    int lastRow = -1;
+    int lastEnd = 0;
+    for(int i = 0; i < result->rows.count(); i++)
+    {
+        int row = result->rows.at(i);
+        int column = result->columns.at(i);
+        if(row != lastRow || column >= lastEnd)
+        {
+            result->matches.append(i);
+            lastRow = row;
+            lastEnd = column + result->lengths.at(i);
+        }
+    }
+    emit finished(generation, result);
+}
+
+void DocumentSearcher::addOccurrence(int row, int column, int length)
+{
+    result->rows.append(row);
+    result->columns.append(column);
+    result->lengths.append(length);
+    if(result->rows.count() >= MaxOccurrences)
+    {
+        result->truncated = true;
+    }
+}
+
+void DocumentSearcher::searchLiteral()
+{
+    Qt::CaseSensitivity caseSensitivity = query.caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
+    int length = query.text.length();
+    //QString::indexOf scans a single character with SSE2, QStringMatcher is Boyer-Moore
+    QStringMatcher matcher(query.text, caseSensitivity);
+    QChar character = query.text.at(0);
+    for(int row = 0; row < lines.count() && !result->truncated; row++)
+    {
+        if((row & 0xfff) == 0 && isCancelled())
+        {
+            return;
+        }
+        const QString &line = lines.at(row);
+        if(line.length() < length)
+        {
+            continue;
+        }
+        int column = length == 1 ? line.indexOf(character, 0, caseSensitivity) : matcher.indexIn(line, 0);
+        while(column != -1 && !result->truncated)
+        {
+            addOccurrence(row, column, length);
+            column = length == 1 ? line.indexOf(character, column + 1, caseSensitivity) : matcher.indexIn(line, column + 1);
+        }
+    }
+}
+
+void DocumentSearcher::refineLiteral()
+{
+    Qt::CaseSensitivity caseSensitivity = query.caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
+    int length = query.text.length();
+    for(int i = 0; i < previous->rows.count(); i++)
+    {
+        if((i & 0xffff) == 0 && isCancelled())
+        {
+            return;
+        }
+        int row = previous->rows.at(i);
+        int column = previous->columns.at(i);
+        if(lines.at(row).midRef(column, length).compare(query.text, caseSensitivity) == 0)
+        {
+            addOccurrence(row, column, length);
+        }
+    }
+}
+
+void DocumentSearcher::searchRegularExpression()
+{
+    QRegularExpression regularExpression(query.text, query.caseSensitive ? QRegularExpression::NoPatternOption : QRegularExpression::CaseInsensitiveOption);
+    if(!regularExpression.isValid())
+    {
+        result->error = regularExpression.errorString();
+        return;
+    }
+    regularExpression.optimize();
+    for(int row = 0; row < lines.count() && !result->truncated; row++)
+    {
+        if((row & 0xfff) == 0 && isCancelled())
+        {
+            return;
+        }
+        QRegularExpressionMatchIterator iterator = regularExpression.globalMatch(lines.at(row));
+        while(iterator.hasNext() && !result->truncated)
+        {
+            QRegularExpressionMatch match = iterator.next();
+            if(match.capturedLength() > 0) //empty matches cannot be highlighted
+            {
+                addOccurrence(row, match.capturedStart(), match.capturedLength());
+            }
+        }
+    }
+}
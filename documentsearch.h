@@ -0,0 +1,62 @@
+#ifndef DOCUMENTSEARCH_H
+#define DOCUMENTSEARCH_H
+
+
+#include <QtCore>
+
+struct SearchQuery
+{
+    QString text;
+    bool caseSensitive;
+    bool regularExpression;
+};
+
+//every occurrence of a query in one version of a document, in document order
+class SearchResult
+{
+public:
+    bool canRefine(const SearchQuery &query) const;
+    int lowerBound(int row) const;
+    int firstMatchAfter(int row, int column) const;
+    SearchQuery query;
+    //overlapping occurrences included, so a longer query can be refined from them
+    QVector<int> rows;
+    QVector<int> columns;
+    QVector<int> lengths;
+    //non-overlapping occurrences, indexes into the vectors above
+    QVector<int> matches;
+    bool truncated;
+    QString error;
+};
+
+typedef QSharedPointer<SearchResult> SearchResultPointer;
+Q_DECLARE_METATYPE(SearchResultPointer)
+
+class DocumentSearcher : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+signals:
+    void finished(int generation, SearchResultPointer searchResult);
+
+public:
+    DocumentSearcher(int generation, QSharedPointer<QAtomicInt> currentGeneration, const QStringList &lines, const SearchQuery &query, SearchResultPointer previous);
+    void run();
+    static const int MaxOccurrences = 5000000;
+
+private:
+    bool isCancelled();
+    void searchLiteral();
+    void refineLiteral();
+    void searchRegularExpression();
+    void addOccurrence(int row, int column, int length);
+    int generation;
+    QSharedPointer<QAtomicInt> currentGeneration;
+    QStringList lines;
+    SearchQuery query;
+    SearchResultPointer previous;
+    SearchResultPointer result;
+};
+
+
+#endif // DOCUMENTSEARCH_H
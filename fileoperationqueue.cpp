@@ -0,0 +1,213 @@
+#include "fileoperationqueue.h"
+
+FileOperationWorker::FileOperationWorker(QAtomicInt *canceled)
+{
+    this->canceled = canceled;
+    this->done = 0;
+    this->total = 0;
+}
+
+void FileOperationWorker::process(QList<FileOperation> batch)
+{
+    done = 0;
+    total = batch.count();
+    progressTimer.start();
+    for(int i = 0; i < batch.count(); i++)
+    {
+        FileOperation &operation = batch[i];
+        if(canceled->loadAcquire())
+        {
+            operation.succeeded = false;
+            operation.error = tr("Canceled");
+            continue;
+        }
+        operation.error.clear();
+        operation.succeeded = run(operation);
+        done++;
+        report(operation.sourcePath);
+    }
+    emit progress(total, total, QString());
+    emit finished(batch);
+}
+
+void FileOperationWorker::report(const QString &path)
+{
+    //progress is throttled, a big folder produces thousands of entries per second
+    if(progressTimer.elapsed() >= 50)
+    {
+        progressTimer.restart();
+        emit progress(done, total, path);
+    }
+}
+
+bool FileOperationWorker::run(FileOperation &operation)
+{
+    QFileInfo sourceInfo(operation.sourcePath);
+    operation.isFolder = sourceInfo.isDir();
+    if(!sourceInfo.exists() && !sourceInfo.isSymLink())
+    {
+        operation.error = tr("%1 does not exist").arg(operation.sourcePath);
+        return false;
+    }
+    if(operation.type == FileOperation::Delete)
+    {
+        return removePath(operation.sourcePath, operation.error);
+    }
+    if(QFileInfo(operation.targetPath).exists())
+    {
+        operation.error = tr("%1 already exists").arg(operation.targetPath);
+        return false;
+    }
+    if(operation.isFolder && (operation.targetPath + "/").startsWith(operation.sourcePath + "/"))
+    {
+        operation.error = tr("Cannot put %1 inside itself").arg(operation.sourcePath);
+        return false;
+    }
+    if(operation.type == FileOperation::Copy)
+    {
+        return copyPath(operation.sourcePath, operation.targetPath, operation.error);
+    }
+    if(QDir().rename(operation.sourcePath, operation.targetPath))
+    {
+        return true;
+    }
+    //rename fails across file systems, fall back to copy and delete
+    if(!copyPath(operation.sourcePath, operation.targetPath, operation.error))
+    {
+        return false;
+    }
+    return removePath(operation.sourcePath, operation.error);
+}
+
+bool FileOperationWorker::removePath(const QString &path, QString &error)
+{
+    QFileInfo fileInfo(path);
+    if(!fileInfo.isDir() || fileInfo.isSymLink())
+    {
+        if(!QFile::remove(path))
+        {
+            error = tr("Cannot delete %1").arg(path);
+            return false;
+        }
+        return true;
+    }
+    QDirIterator iterator(path, QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System);
+    while(iterator.hasNext())
+    {
+        if(canceled->loadAcquire())
+        {
+            error = tr("Canceled");
+            return false;
+        }
+        iterator.next();
+        if(!removePath(iterator.filePath(), error))
+        {
+            return false;
+        }
+        report(iterator.filePath());
+    }
+    if(!QDir().rmdir(path))
+    {
+        error = tr("Cannot delete %1").arg(path);
+        return false;
+    }
+    return true;
+}
+
+bool FileOperationWorker::copyPath(const QString &sourcePath, const QString &targetPath, QString &error)
+{
+    if(canceled->loadAcquire())
+    {
+        error = tr("Canceled");
+        return false;
+    }
+    QFileInfo fileInfo(sourcePath);
+    //links are copied as links, following them could recurse forever on a cycle
+    if(fileInfo.isSymLink())
+    {
+        if(!QFile::link(fileInfo.symLinkTarget(), targetPath))
+        {
+            error = tr("Cannot copy %1 to %2").arg(sourcePath, targetPath);
+            return false;
+        }
+        report(sourcePath);
+        return true;
+    }
+    if(!fileInfo.isDir())
+    {
+        if(!QFile::copy(sourcePath, targetPath))
+        {
+            error = tr("Cannot copy %1 to %2").arg(sourcePath, targetPath);
+            return false;
+        }
+        report(sourcePath);
+        return true;
+    }
+    if(!QDir().mkpath(targetPath))
+    {
+        error = tr("Cannot create %1").arg(targetPath);
+        return false;
+    }
+    QDirIterator iterator(sourcePath, QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System);
+    while(iterator.hasNext())
+    {
+        iterator.next();
+        if(!copyPath(iterator.filePath(), QDir(targetPath).absoluteFilePath(iterator.fileName()), error))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+FileOperationQueue::FileOperationQueue(QObject *parent) : QObject(parent)
+{
+    qRegisterMetaType<FileOperation>("FileOperation");
+    qRegisterMetaType<QList<FileOperation> >("QList<FileOperation>");
+    pendingBatches = 0;
+    worker = new FileOperationWorker(&canceled);
+    worker->moveToThread(&thread);
+    connect(&thread, SIGNAL(finished()), worker, SLOT(deleteLater()));
+    connect(this, SIGNAL(batchRequested(QList<FileOperation>)), worker, SLOT(process(QList<FileOperation>)));
+    connect(worker, SIGNAL(progress(int, int, QString)), this, SIGNAL(progress(int, int, QString)));
+    connect(worker, SIGNAL(finished(QList<FileOperation>)), this, SLOT(finish(QList<FileOperation>)));
+    thread.start();
+}
+
+FileOperationQueue::~FileOperationQueue()
+{
+    canceled.storeRelease(1);
+    thread.quit();
+    thread.wait();
+}
+
+bool FileOperationQueue::isBusy() const
+{
+    return pendingBatches > 0;
+}
+
+void FileOperationQueue::enqueue(QList<FileOperation> batch)
+{
+    if(batch.isEmpty())
+    {
+        return;
+    }
+    //a cancel stays in effect for every batch queued before it
+    if(pendingBatches++ == 0)
+    {
+        canceled.storeRelease(0);
+        emit started();
+    }
+    emit batchRequested(batch);
+}
+
+void FileOperationQueue::cancel()
+{
+    canceled.storeRelease(1);
+}
+
+void FileOperationQueue::finish(QList<FileOperation> results)
+{
+    pendingBatches--;
+    emit finished(results);
+}
@@ -0,0 +1,82 @@
+#ifndef FILEOPERATIONQUEUE_H
+#define FILEOPERATIONQUEUE_H
+
+
+#include <QtCore>
+
+struct FileOperation
+{
+    enum Type
+    {
+        Delete,
+        Rename,
+        Move,
+        Copy
+    };
+    Type type;
+    QString sourcePath;
+    QString targetPath;
+    bool isFolder;
+    bool succeeded;
+    QString error;
+};
+
+Q_DECLARE_METATYPE(FileOperation)
+
+class FileOperationWorker : public QObject
+{
+    Q_OBJECT
+
+signals:
+    void progress(int done, int total, QString path);
+    void finished(QList<FileOperation> results);
+
+public:
+    FileOperationWorker(QAtomicInt *canceled);
+
+public slots:
+    void process(QList<FileOperation> batch);
+
+private:
+    bool run(FileOperation &operation);
+    bool removePath(const QString &path, QString &error);
+    bool copyPath(const QString &sourcePath, const QString &targetPath, QString &error);
+    void report(const QString &path);
+    QAtomicInt *canceled;
+    QElapsedTimer progressTimer;
+    int done;
+    int total;
+};
+
+//runs file operations on a worker thread, one batch after another
+class FileOperationQueue : public QObject
+{
+    Q_OBJECT
+
+signals:
+    void progress(int done, int total, QString path);
+    void finished(QList<FileOperation> results);
+    void started();
+    void batchRequested(QList<FileOperation> batch);
+
+public:
+    FileOperationQueue(QObject *parent);
+    ~FileOperationQueue();
+    bool isBusy() const;
+
+public slots:
+    void enqueue(QList<FileOperation> batch);
+    void cancel();
+
+private slots:
+    void finish(QList<FileOperation> results);
+
+private:
+    QThread thread;
+    FileOperationWorker *worker;
+    QAtomicInt canceled;
+    int pendingBatches;
+};
+
+
+#endif // FILEOPERATIONQUEUE_H
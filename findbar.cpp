@@ -0,0 +1,102 @@
+#include "findbar.h"
+
+FindBar::FindBar(QWidget *parent) : QFrame(parent)
+{
+    this->setFrameShape(QFrame::StyledPanel);
+    this->setAutoFillBackground(true);
+    this->setCursor(Qt::ArrowCursor);
+    lineEdit = new QLineEdit();
+    lineEdit->setPlaceholderText(tr("Find"));
+    lineEdit->setMinimumWidth(200);
+    lineEdit->installEventFilter(this);
+    connect(lineEdit, SIGNAL(textChanged(QString)), this, SIGNAL(queryChanged()));
+    caseButton = new QToolButton();
+    caseButton->setText("Aa");
+    caseButton->setToolTip(tr("Match Case"));
+    caseButton->setCheckable(true);
+    connect(caseButton, SIGNAL(toggled(bool)), this, SIGNAL(queryChanged()));
+    regularExpressionButton = new QToolButton();
+    regularExpressionButton->setText(".*");
+    regularExpressionButton->setToolTip(tr("Regular Expression"));
+    regularExpressionButton->setCheckable(true);
+    connect(regularExpressionButton, SIGNAL(toggled(bool)), this, SIGNAL(queryChanged()));
+    statusLabel = new QLabel();
+    statusLabel->setMinimumWidth(100);
+    QToolButton *previousButton = new QToolButton();
+    previousButton->setArrowType(Qt::UpArrow);
+    previousButton->setToolTip(tr("Previous (Shift+Enter)"));
+    connect(previousButton, SIGNAL(clicked()), this, SIGNAL(previousRequested()));
+    QToolButton *nextButton = new QToolButton();
+    nextButton->setArrowType(Qt::DownArrow);
+    nextButton->setToolTip(tr("Next (Enter)"));
+    connect(nextButton, SIGNAL(clicked()), this, SIGNAL(nextRequested()));
+    QToolButton *closeButton = new QToolButton();
+    closeButton->setText(QString::fromUtf8("\xC3\x97"));
+    closeButton->setToolTip(tr("Close (Esc)"));
+    connect(closeButton, SIGNAL(clicked()), this, SIGNAL(closed()));
+
+    QHBoxLayout *layout = new QHBoxLayout();
+    layout->addWidget(lineEdit);
+    layout->addWidget(caseButton);
+    layout->addWidget(regularExpressionButton);
+    layout->addWidget(statusLabel);
+    layout->addWidget(previousButton);
+    layout->addWidget(nextButton);
+    layout->addWidget(closeButton);
+    layout->setContentsMargins(4, 4, 4, 4);
+    layout->setSpacing(2);
+    this->setLayout(layout);
+    this->hide();
+}
+
+SearchQuery FindBar::query() const
+{
+    SearchQuery query;
+    query.text = lineEdit->text();
+    query.caseSensitive = caseButton->isChecked();
+    query.regularExpression = regularExpressionButton->isChecked();
+    return query;
+}
+
+void FindBar::open(const QString &text)
+{
+    this->show();
+    this->raise();
+    if(!text.isEmpty() && !text.contains('\n'))
+    {
+        lineEdit->setText(text);
+    }
+    lineEdit->selectAll();
+    lineEdit->setFocus();
+}
+
+void FindBar::setStatus(const QString &status)
+{
+    statusLabel->setText(status);
+}
+
+bool FindBar::eventFilter(QObject *object, QEvent *event)
+{
+    if(object == lineEdit && event->type() == QEvent::KeyPress)
+    {
+        QKeyEvent *keyEvent = (QKeyEvent*)event;
+        if(keyEvent->key() == Qt::Key_Escape)
+        {
+            emit closed();
+            return true;
+        }
+        if(keyEvent->key() == Qt::Key_Return || keyEvent->key() == Qt::Key_Enter)
+        {
+            if(keyEvent->modifiers() & Qt::ShiftModifier)
+            {
+                emit previousRequested();
+            }
+            else
+            {
+                emit nextRequested();
+            }
+            return true;
+        }
+    }
+    return QFrame::eventFilter(object, event);
+}
@@ -0,0 +1,36 @@
+#ifndef FINDBAR_H
+#define FINDBAR_H
+
+
+#include <QtWidgets>
+#include "documentsearch.h"
+
+//find box over the editor for documents too large for Ace's own search
+class FindBar : public QFrame
+{
+    Q_OBJECT
+
+signals:
+    void queryChanged();
+    void nextRequested();
+    void previousRequested();
+    void closed();
+
+public:
+    FindBar(QWidget *parent);
+    SearchQuery query() const;
+    void open(const QString &text);
+    void setStatus(const QString &status);
+
+protected:
+    bool eventFilter(QObject *object, QEvent *event);
+
+private:
+    QLineEdit *lineEdit;
+    QToolButton *caseButton;
+    QToolButton *regularExpressionButton;
+    QLabel *statusLabel;
+};
+
+
+#endif // FINDBAR_H
@@ -1,5 +1,7 @@
 #include "findfiledialog.h"
 #include "mainwindow.h"
+#include "projectfiles.h"
+#include "contentcache.h"
 
 FindFileDialog::FindFileDialog(QString folderPath)
 {
@@ -31,15 +33,10 @@ void FindFileDialog::showFiles(QString s)
     QStringListModel *stringListModel = new QStringListModel(listView);
     QStringList *stringList = new QStringList();
 
-    QDirIterator directory_walker(folderPath, QDir::Files | QDir::NoSymLinks, QDirIterator::Subdirectories);
-    while(directory_walker.hasNext())
+    ProjectWalker walker(folderPath);
+    while(walker.hasNext())
     {
-        directory_walker.next();
-        QString fileName = directory_walker.filePath().mid(folderPath.length() + 1);
-        if(fileName.endsWith(".pyc"))
-        {
-            continue;
-        }
+        QString fileName = walker.next().mid(folderPath.length() + 1);
         if(fileName.contains(s))
         {
             stringList->append(fileName);
@@ -50,6 +47,12 @@ void FindFileDialog::showFiles(QString s)
         }
     }
 
+    //the top results are read ahead while the user is still typing
+    for(int i = 0; i < stringList->size() && i < 3; i++)
+    {
+        ContentCache::instance()->prefetch(folderPath + "/" + stringList->at(i));
+    }
+
     stringListModel->setStringList(*stringList);
     listView->setModel(stringListModel);
 }
@@ -0,0 +1,47 @@
+#include "findsymboldialog.h"
+#include "mainwindow.h"
+
+FindSymbolDialog::FindSymbolDialog(QString text)
+{
+    this->setWindowFlags(Qt::WindowStaysOnTopHint);
+    this->setWindowTitle(tr("Find Symbol"));
+    lineEdit = new QLineEdit();
+    lineEdit->setFixedWidth(512);
+    QVBoxLayout *layout = new QVBoxLayout();
+    layout->addWidget(lineEdit);
+    this->setLayout(layout);
+
+    QRect screenGeometry = QApplication::desktop()->screenGeometry();
+    move(screenGeometry.center() - rect().center());
+
+    connect(lineEdit, SIGNAL(textChanged(const QString &)), this, SLOT(showSymbols(const QString &)));
+
+    listView = new QListView(lineEdit);
+    listView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    connect(listView, SIGNAL(clicked(QModelIndex)), this, SLOT(openSymbol(QModelIndex)));
+    layout->addWidget(listView);
+
+    layout->setSpacing(0);
+    this->adjustSize();
+    lineEdit->setText(text);
+}
+
+void FindSymbolDialog::showSymbols(QString s)
+{
+    QStringListModel *stringListModel = new QStringListModel(listView);
+    QStringList stringList;
+    symbols = s.isEmpty() ? QList<Symbol>() : SymbolIndex::instance()->find(s, 32);
+    foreach(const Symbol &symbol, symbols)
+    {
+        stringList << QString("%1  (%2)  %3:%4").arg(symbol.name, symbol.kind, QFileInfo(symbol.filePath).fileName()).arg(symbol.line);
+    }
+    stringListModel->setStringList(stringList);
+    listView->setModel(stringListModel);
+}
+
+void FindSymbolDialog::openSymbol(QModelIndex modelIndex)
+{
+    const Symbol &symbol = symbols.at(modelIndex.row());
+    emit MainWindow::GetInstance()->openFileAtLineRequested(symbol.filePath, symbol.line);
+    this->close();
+}
@@ -0,0 +1,26 @@
+#ifndef FINDSYMBOLDIALOG_H
+#define FINDSYMBOLDIALOG_H
+
+
+#include <QtWidgets>
+#include "symbolindex.h"
+
+class FindSymbolDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    FindSymbolDialog(QString text);
+
+private slots:
+    void showSymbols(QString s);
+    void openSymbol(QModelIndex modelIndex);
+
+private:
+    QLineEdit *lineEdit;
+    QListView *listView;
+    QList<Symbol> symbols;
+};
+
+
+#endif // FINDSYMBOLDIALOG_H
@@ -0,0 +1,442 @@
+#include "gitignore.h"
+
+const int GitIgnore::RecheckInterval;
+const int GitIgnore::MaxCachedFiles;
+
+IgnoreRules::IgnoreRules(const QString &basePath, const QByteArray &content)
+{
+    this->basePath = basePath == "/" ? QString() : basePath;
+    QList<QByteArray> lines = content.split('\n');
+    for(int i = 0; i < lines.count(); i++)
+    {
+        add(QString::fromUtf8(lines[i]));
+    }
+}
+
+void IgnoreRules::add(QString pattern)
+{
+    if(pattern.endsWith('\r'))
+    {
+        pattern.chop(1);
+    }
+    //trailing spaces are ignored unless escaped
+    while(pattern.endsWith(' ') && !pattern.endsWith("\\ "))
+    {
+        pattern.chop(1);
+    }
+    if(pattern.isEmpty() || pattern.startsWith('#'))
+    {
+        return;
+    }
+    bool isNegated = false;
+    if(pattern.startsWith('!'))
+    {
+        isNegated = true;
+        pattern = pattern.mid(1);
+    }
+    else if(pattern.startsWith("\\!") || pattern.startsWith("\\#"))
+    {
+        pattern = pattern.mid(1);
+    }
+    bool dirOnly = false;
+    if(pattern.endsWith('/'))
+    {
+        dirOnly = true;
+        pattern.chop(1);
+    }
+    //a slash at the beginning or in the middle anchors the pattern to the folder of the ignore file
+    bool anchored = pattern.contains('/');
+    if(pattern.startsWith('/'))
+    {
+        pattern = pattern.mid(1);
+    }
+    if(pattern.isEmpty())
+    {
+        return;
+    }
+    int rule = negated.count();
+    negated.append(isNegated);
+    Table &table = dirOnly ? dirTable : anyTable;
+    static const QRegularExpression wildcards("[*?\\[\\\\]");
+    if(!pattern.contains(wildcards))
+    {
+        (anchored ? table.paths : table.names).insert(pattern, rule);
+        return;
+    }
+    if(!anchored && pattern.startsWith('*') && !pattern.mid(1).contains(wildcards))
+    {
+        QString suffix = pattern.mid(1);
+        table.suffixes.insert(suffix, rule);
+        if(!table.suffixLengths.contains(suffix.length()))
+        {
+            table.suffixLengths.append(suffix.length());
+        }
+        return;
+    }
+    Glob glob;
+    glob.rule = rule;
+    glob.anchored = anchored;
+    glob.dirOnly = dirOnly;
+    glob.regularExpression = QRegularExpression(globToRegularExpression(pattern));
+    glob.regularExpression.optimize();
+    globs.prepend(glob); //the last matching rule wins, so globs are tried from the end
+}
+
+QString IgnoreRules::globToRegularExpression(const QString &glob)
+{
+    QString result = "^";
+    int length = glob.length();
+    for(int i = 0; i < length; i++)
+    {
+        QChar c = glob.at(i);
+        if(c == '*')
+        {
+            bool doubleStar = i + 1 < length && glob.at(i + 1) == '*';
+            bool atSegmentStart = i == 0 || glob.at(i - 1) == '/';
+            if(doubleStar && atSegmentStart && (i + 2 == length || glob.at(i + 2) == '/'))
+            {
+                if(i + 2 == length)
+                {
+                    result += ".*";
+                }
+                else
+                {
+                    result += "(?:.*/)?";
+                    i++;
+                }
+                i++;
+                continue;
+            }
+            result += "[^/]*";
+        }
+        else if(c == '?')
+        {
+            result += "[^/]";
+        }
+        else if(c == '[')
+        {
+            int end = glob.indexOf(']', i + 2);
+            if(end == -1)
+            {
+                result += "\\[";
+                continue;
+            }
+            QString set = glob.mid(i + 1, end - i - 1);
+            if(set.startsWith('!'))
+            {
+                set[0] = '^';
+            }
+            set.replace("\\", "\\\\");
+            result += "[" + set + "]";
+            i = end;
+        }
+        else if(c == '\\' && i + 1 < length)
+        {
+            result += QRegularExpression::escape(glob.at(++i));
+        }
+        else
+        {
+            result += QRegularExpression::escape(c);
+        }
+    }
+    return result + "$";
+}
+
+int IgnoreRules::lookup(const Table &table, const QString &relativePath, const QString &name)
+{
+    int rule = qMax(table.names.value(name, -1), table.paths.value(relativePath, -1));
+    for(int i = 0; i < table.suffixLengths.count(); i++)
+    {
+        int length = table.suffixLengths.at(i);
+        if(name.length() >= length)
+        {
+            rule = qMax(rule, table.suffixes.value(name.right(length), -1));
+        }
+    }
+    return rule;
+}
+
+//index of the last rule matching path, -1 if none does
+int IgnoreRules::match(const QString &path, const QString &name, bool isDir) const
+{
+    QString relativePath = path.mid(basePath.length() + 1);
+    int rule = lookup(anyTable, relativePath, name);
+    if(isDir)
+    {
+        rule = qMax(rule, lookup(dirTable, relativePath, name));
+    }
+    for(int i = 0; i < globs.count(); i++)
+    {
+        const Glob &glob = globs.at(i);
+        if(glob.rule <= rule)
+        {
+            break;
+        }
+        if(glob.dirOnly && !isDir)
+        {
+            continue;
+        }
+        if(glob.regularExpression.match(glob.anchored ? relativePath : name).hasMatch())
+        {
+            rule = glob.rule;
+            break;
+        }
+    }
+    return rule;
+}
+
+bool IgnoreRules::isNegated(int rule) const
+{
+    return negated.at(rule);
+}
+
+bool IgnoreRules::isEmpty() const
+{
+    return negated.isEmpty();
+}
+
+GitIgnore::GitIgnore()
+{
+    generation = 0;
+    ignoredDirsGeneration = 0;
+    ignoredFilesGeneration = 0;
+}
+
+GitIgnore *GitIgnore::instance()
+{
+    static GitIgnore gitIgnore;
+    return &gitIgnore;
+}
+
+QSharedPointer<IgnoreRules> GitIgnore::rules(const QString &dirPath, const QString &ignoreFilePath)
+{
+    //called with mutex locked
+    QHash<QString, Entry>::iterator it = entries.find(ignoreFilePath);
+    if(it != entries.end() && it->checked.elapsed() < RecheckInterval)
+    {
+        return it->rules;
+    }
+    QFileInfo fileInfo(ignoreFilePath);
+    QDateTime modified = fileInfo.exists() ? fileInfo.lastModified() : QDateTime();
+    qint64 size = fileInfo.exists() ? fileInfo.size() : -1;
+    if(it != entries.end() && it->modified == modified && it->size == size)
+    {
+        it->checked.restart();
+        return it->rules;
+    }
+    Entry entry;
+    entry.modified = modified;
+    entry.size = size;
+    entry.checked.start();
+    QFile file(ignoreFilePath);
+    if(size > 0 && file.open(QIODevice::ReadOnly))
+    {
+        QSharedPointer<IgnoreRules> rules(new IgnoreRules(dirPath, file.readAll()));
+        file.close();
+        if(!rules->isEmpty())
+        {
+            entry.rules = rules;
+        }
+    }
+    if(it != entries.end())
+    {
+        generation++;
+    }
+    entries.insert(ignoreFilePath, entry);
+    return entry.rules;
+}
+
+QString GitIgnore::repositoryRoot(const QString &dirPath)
+{
+    //called with mutex locked
+    QHash<QString, QString>::const_iterator it = repositoryRoots.constFind(dirPath);
+    if(it != repositoryRoots.constEnd())
+    {
+        return it.value();
+    }
+    QString root;
+    QDir dir(dirPath);
+    do
+    {
+        if(QFileInfo(dir.filePath(".git")).exists())
+        {
+            root = dir.absolutePath();
+            break;
+        }
+    }
+    while(dir.cdUp());
+    repositoryRoots.insert(dirPath, root);
+    return root;
+}
+
+bool GitIgnore::contains(const QString &folderPath, const QString &path)
+{
+    return path == folderPath || path.startsWith(folderPath.endsWith('/') ? folderPath : folderPath + "/");
+}
+
+//the highest folder whose ignore files apply to dirPath: the repository root, outside of a
+//repository the opened project folder, so ignore files above the work tree are never read
+QString GitIgnore::topLevel(const QString &dirPath)
+{
+    //called with mutex locked
+    QString root = repositoryRoot(dirPath);
+    if(!root.isEmpty())
+    {
+        return root;
+    }
+    QString folder = dirPath;
+    foreach(const QString &projectFolder, projectFolders)
+    {
+        if(contains(projectFolder, dirPath) && projectFolder.length() < folder.length())
+        {
+            folder = projectFolder;
+        }
+    }
+    return folder;
+}
+
+void GitIgnore::addProjectFolder(const QString &folderPath)
+{
+    QMutexLocker locker(&mutex);
+    QString path = QDir(folderPath).absolutePath();
+    if(!projectFolders.contains(path))
+    {
+        projectFolders.append(path);
+        generation++;
+    }
+}
+
+//ignore files that apply to the entries of dirPath, the deepest (highest precedence) first
+IgnoreChain GitIgnore::chain(const QString &dirPath)
+{
+    QMutexLocker locker(&mutex);
+    IgnoreChain chain;
+    QString root = repositoryRoot(dirPath);
+    QString top = topLevel(dirPath);
+    QString path = dirPath;
+    while(true)
+    {
+        QSharedPointer<IgnoreRules> rules = this->rules(path, path + "/.gitignore");
+        if(!rules.isNull())
+        {
+            chain.append(rules);
+        }
+        int slash = path.lastIndexOf('/');
+        if(path == top || slash <= 0)
+        {
+            break;
+        }
+        path = path.left(slash);
+    }
+    if(!root.isEmpty())
+    {
+        QSharedPointer<IgnoreRules> exclude = this->rules(root, root + "/.git/info/exclude");
+        if(!exclude.isNull())
+        {
+            chain.append(exclude);
+        }
+    }
+    return chain;
+}
+
+//for callers that are notified of changes and should not wait for the next recheck
+void GitIgnore::invalidate(const QString &ignoreFilePath)
+{
+    QMutexLocker locker(&mutex);
+    if(entries.remove(ignoreFilePath) > 0)
+    {
+        generation++;
+    }
+}
+
+bool GitIgnore::isIgnored(const IgnoreChain &chain, const QString &path, const QString &name, bool isDir)
+{
+    if(name == ".git")
+    {
+        return true;
+    }
+    for(int i = 0; i < chain.count(); i++)
+    {
+        int rule = chain.at(i)->match(path, name, isDir);
+        if(rule != -1)
+        {
+            return !chain.at(i)->isNegated(rule);
+        }
+    }
+    return false;
+}
+
+bool GitIgnore::isIgnoredDir(const QString &dirPath)
+{
+    int slash = dirPath.lastIndexOf('/');
+    if(slash <= 0)
+    {
+        return false;
+    }
+    {
+        QMutexLocker locker(&mutex);
+        if(ignoredDirsGeneration != generation)
+        {
+            ignoredDirs.clear();
+            ignoredDirsGeneration = generation;
+        }
+        QHash<QString, bool>::const_iterator it = ignoredDirs.constFind(dirPath);
+        if(it != ignoredDirs.constEnd())
+        {
+            return it.value();
+        }
+    }
+    QString top;
+    {
+        QMutexLocker locker(&mutex);
+        top = topLevel(dirPath);
+    }
+    //the repository root or project folder itself is never ignored, and nothing above it is looked at
+    if(dirPath == top || !contains(top, dirPath))
+    {
+        return false;
+    }
+    QString parentPath = dirPath.left(slash);
+    //nothing below an ignored folder can be re-included
+    bool ignored = isIgnoredDir(parentPath) || isIgnored(chain(parentPath), dirPath, dirPath.mid(slash + 1), true);
+    QMutexLocker locker(&mutex);
+    ignoredDirs.insert(dirPath, ignored);
+    return ignored;
+}
+
+bool GitIgnore::isIgnored(const QString &path, bool isDir)
+{
+    if(isDir)
+    {
+        return isIgnoredDir(path);
+    }
+    int slash = path.lastIndexOf('/');
+    if(slash == -1)
+    {
+        return false;
+    }
+    //asked for every painted row of the project tree, so the answer is cached like the folders'
+    int cacheGeneration;
+    {
+        QMutexLocker locker(&mutex);
+        if(ignoredFilesGeneration != generation || ignoredFiles.count() >= MaxCachedFiles)
+        {
+            ignoredFiles.clear();
+            ignoredFilesGeneration = generation;
+        }
+        QHash<QString, bool>::const_iterator it = ignoredFiles.constFind(path);
+        if(it != ignoredFiles.constEnd())
+        {
+            return it.value();
+        }
+        cacheGeneration = generation;
+    }
+    QString parentPath = slash == 0 ? QString("/") : path.left(slash);
+    bool ignored = isIgnoredDir(parentPath) || isIgnored(chain(parentPath), path, path.mid(slash + 1), false);
+    QMutexLocker locker(&mutex);
+    if(cacheGeneration == generation)
+    {
+        ignoredFiles.insert(path, ignored);
+    }
+    return ignored;
+}
@@ -0,0 +1,84 @@
+#ifndef GITIGNORE_H
+#define GITIGNORE_H
+
+
+#include <QtCore>
+
+//one compiled ignore file; literal names, literal paths and "*.suffix" patterns are hash lookups,
+//only real globs are matched with (JIT compiled) regular expressions
+class IgnoreRules
+{
+public:
+    IgnoreRules(const QString &basePath, const QByteArray &content);
+    int match(const QString &path, const QString &name, bool isDir) const;
+    bool isNegated(int rule) const;
+    bool isEmpty() const;
+
+private:
+    struct Glob
+    {
+        int rule;
+        bool anchored;
+        bool dirOnly;
+        QRegularExpression regularExpression;
+    };
+    struct Table
+    {
+        QHash<QString, int> names;
+        QHash<QString, int> paths;
+        QHash<QString, int> suffixes;
+        QList<int> suffixLengths;
+    };
+    void add(QString pattern);
+    static int lookup(const Table &table, const QString &relativePath, const QString &name);
+    static QString globToRegularExpression(const QString &glob);
+    QString basePath;
+    QVector<bool> negated;
+    Table anyTable;
+    Table dirTable;
+    QList<Glob> globs;
+};
+
+typedef QList<QSharedPointer<IgnoreRules> > IgnoreChain;
+
+//.gitignore semantics for every folder, compiled rules are cached per directory and
+//revalidated against the ignore file at most every RecheckInterval milliseconds
+class GitIgnore
+{
+public:
+    static GitIgnore *instance();
+    bool isIgnored(const QString &path, bool isDir);
+    IgnoreChain chain(const QString &dirPath);
+    static bool isIgnored(const IgnoreChain &chain, const QString &path, const QString &name, bool isDir);
+    void invalidate(const QString &ignoreFilePath);
+    void addProjectFolder(const QString &folderPath);
+    static const int RecheckInterval = 2000;
+    static const int MaxCachedFiles = 100000;
+
+private:
+    GitIgnore();
+    struct Entry
+    {
+        QSharedPointer<IgnoreRules> rules;
+        QDateTime modified;
+        qint64 size;
+        QElapsedTimer checked;
+    };
+    QSharedPointer<IgnoreRules> rules(const QString &dirPath, const QString &ignoreFilePath);
+    QString repositoryRoot(const QString &dirPath);
+    QString topLevel(const QString &dirPath);
+    static bool contains(const QString &folderPath, const QString &path);
+    bool isIgnoredDir(const QString &dirPath);
+    QMutex mutex;
+    QHash<QString, Entry> entries;
+    QHash<QString, QString> repositoryRoots;
+    QStringList projectFolders;
+    QHash<QString, bool> ignoredDirs;
+    QHash<QString, bool> ignoredFiles;
+    int generation;
+    int ignoredDirsGeneration;
+    int ignoredFilesGeneration;
+};
+
+
+#endif // GITIGNORE_H
@@ -0,0 +1,428 @@
+#include "gitstatus.h"
+#include "gitignore.h"
+#include <string.h>
+
+static quint32 readUInt32(const uchar *data)
+{
+    return (quint32(data[0]) << 24) | (quint32(data[1]) << 16) | (quint32(data[2]) << 8) | quint32(data[3]);
+}
+
+static quint16 readUInt16(const uchar *data)
+{
+    return (quint16(data[0]) << 8) | quint16(data[1]);
+}
+
+QSharedPointer<GitIndex> GitIndex::read(const QString &filePath, int hashSize)
+{
+    QSharedPointer<GitIndex> index(new GitIndex());
+    index->modified = 0;
+    QFile file(filePath);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return index;
+    }
+    index->modified = QFileInfo(file).lastModified().toMSecsSinceEpoch() / 1000;
+    qint64 size = file.size();
+    const uchar *data = size >= 12 ? file.map(0, size) : 0;
+    if(data == 0 || memcmp(data, "DIRC", 4) != 0)
+    {
+        return index;
+    }
+    quint32 version = readUInt32(data + 4);
+    quint32 count = readUInt32(data + 8);
+    if(version < 2 || version > 4)
+    {
+        return index;
+    }
+    const uchar *end = data + size;
+    const uchar *p = data + 12;
+    QByteArray name;
+    int flagsOffset = 40 + hashSize;
+    index->entries.reserve(count);
+    for(quint32 i = 0; i < count; i++)
+    {
+        const uchar *entryStart = p;
+        if(end - p < flagsOffset + 2)
+        {
+            break;
+        }
+        quint16 flags = readUInt16(p + flagsOffset);
+        quint16 extendedFlags = 0;
+        const uchar *namePointer = p + flagsOffset + 2;
+        if(version >= 3 && (flags & 0x4000))
+        {
+            extendedFlags = readUInt16(namePointer);
+            namePointer += 2;
+        }
+        if(version == 4)
+        {
+            //the name is stored as "drop N bytes of the previous name" plus a NUL terminated suffix
+            quint64 drop = 0;
+            uchar c;
+            do
+            {
+                if(namePointer >= end)
+                {
+                    return index;
+                }
+                c = *namePointer++;
+                drop = (drop << 7) | (c & 0x7f);
+                if(c & 0x80)
+                {
+                    drop++;
+                }
+            }
+            while(c & 0x80);
+            const uchar *nul = (const uchar*)memchr(namePointer, 0, end - namePointer);
+            if(nul == 0 || drop > (quint64)name.size())
+            {
+                return index;
+            }
+            name.chop((int)drop);
+            name.append((const char*)namePointer, nul - namePointer);
+            p = nul + 1;
+        }
+        else
+        {
+            const uchar *nul = (const uchar*)memchr(namePointer, 0, end - namePointer);
+            if(nul == 0)
+            {
+                return index;
+            }
+            name = QByteArray((const char*)namePointer, nul - namePointer);
+            //entries are padded with 1 to 8 NUL bytes to a multiple of eight
+            p = entryStart + (((namePointer - entryStart) + name.size() + 8) & ~7);
+        }
+        int stage = (flags >> 12) & 3;
+        QString path = QString::fromUtf8(name);
+        GitIndexEntry entry;
+        entry.mtime = readUInt32(entryStart + 8);
+        entry.size = readUInt32(entryStart + 36);
+        entry.hash = QByteArray((const char*)entryStart + 40, hashSize);
+        entry.conflicted = stage != 0 || (extendedFlags & 0x2000); //unmerged or intent-to-add
+        entry.skipWorktree = extendedFlags & 0x4000;
+        index->entries.insert(path, entry);
+        for(int slash = path.lastIndexOf('/'); slash > 0; slash = path.lastIndexOf('/', slash - 1))
+        {
+            QString dir = path.left(slash);
+            if(index->dirs.contains(dir))
+            {
+                break;
+            }
+            index->dirs.insert(dir);
+        }
+    }
+    file.unmap((uchar*)data);
+    return index;
+}
+
+GitStatusScanner::GitStatusScanner(const QString &root, const QString &gitDir, int hashSize, QSharedPointer<GitIndex> index, const QStringList &paths)
+{
+    this->root = root;
+    this->gitDir = gitDir;
+    this->hashSize = hashSize;
+    this->index = index;
+    this->paths = paths;
+}
+
+QByteArray GitStatusScanner::blobHash(const QString &filePath, qint64 size)
+{
+    QCryptographicHash hash(hashSize == 32 ? QCryptographicHash::Sha256 : QCryptographicHash::Sha1);
+    hash.addData(QString("blob %1").arg(size).toLatin1());
+    hash.addData("\0", 1);
+    QFile file(filePath);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return QByteArray();
+    }
+    while(!file.atEnd())
+    {
+        hash.addData(file.read(64 * 1024));
+    }
+    file.close();
+    return hash.result();
+}
+
+int GitStatusScanner::check(const QString &relativePath, const GitIndexEntry &entry, qint64 indexModified)
+{
+    if(entry.skipWorktree)
+    {
+        return GitStatus::Clean;
+    }
+    if(entry.conflicted)
+    {
+        return GitStatus::Modified;
+    }
+    QFileInfo fileInfo(root + "/" + relativePath);
+    if(!fileInfo.exists())
+    {
+        return GitStatus::Modified; //deleted
+    }
+    qint64 size = fileInfo.size();
+    if((size & 0xffffffff) != entry.size)
+    {
+        return GitStatus::Modified;
+    }
+    qint64 mtime = fileInfo.lastModified().toMSecsSinceEpoch() / 1000;
+    //a file written in the same second as the index ("racy git") can't be trusted either
+    if(mtime == entry.mtime && mtime < indexModified)
+    {
+        return GitStatus::Clean;
+    }
+    return blobHash(fileInfo.absoluteFilePath(), size) == entry.hash ? GitStatus::Clean : GitStatus::Modified;
+}
+
+void GitStatusScanner::run()
+{
+    GitStatusScan scan;
+    scan.full = index.isNull();
+    if(scan.full)
+    {
+        index = GitIndex::read(gitDir + "/index", hashSize);
+    }
+    scan.index = index;
+    scan.paths = paths;
+    if(scan.full)
+    {
+        for(QHash<QString, GitIndexEntry>::const_iterator it = index->entries.constBegin(); it != index->entries.constEnd(); ++it)
+        {
+            int status = check(it.key(), it.value(), index->modified);
+            if(status != GitStatus::Clean)
+            {
+                scan.statuses.insert(it.key(), status);
+            }
+        }
+    }
+    else
+    {
+        for(int i = 0; i < paths.count(); i++)
+        {
+            QHash<QString, GitIndexEntry>::const_iterator it = index->entries.constFind(paths[i]);
+            if(it != index->entries.constEnd())
+            {
+                int status = check(it.key(), it.value(), index->modified);
+                if(status != GitStatus::Clean)
+                {
+                    scan.statuses.insert(it.key(), status);
+                }
+            }
+        }
+    }
+    emit scanned(scan);
+}
+
+GitStatus::GitStatus(QObject *parent, const QString &folderPath) : QObject(parent)
+{
+    hashSize = 20;
+    fullScanPending = true;
+    scanning = false;
+    QDir dir(folderPath);
+    do
+    {
+        QFileInfo gitInfo(dir.filePath(".git"));
+        if(gitInfo.isDir())
+        {
+            root = dir.absolutePath();
+            gitDir = gitInfo.absoluteFilePath();
+        }
+        else if(gitInfo.isFile())
+        {
+            //worktrees and submodules point to the real git directory
+            QFile file(gitInfo.absoluteFilePath());
+            if(file.open(QIODevice::ReadOnly))
+            {
+                QString line = QString::fromUtf8(file.readLine()).trimmed();
+                file.close();
+                if(line.startsWith("gitdir:"))
+                {
+                    root = dir.absolutePath();
+                    gitDir = QDir(root).absoluteFilePath(line.mid(7).trimmed());
+                }
+            }
+        }
+    }
+    while(root.isEmpty() && dir.cdUp());
+
+    timer = new QTimer(this);
+    timer->setSingleShot(true);
+    timer->setInterval(300);
+    connect(timer, SIGNAL(timeout()), this, SLOT(scan()));
+    fileSystemWatcher = new QFileSystemWatcher(this);
+    connect(fileSystemWatcher, SIGNAL(fileChanged(QString)), this, SLOT(indexChanged()));
+    if(root.isEmpty())
+    {
+        return;
+    }
+    QFile config(gitDir + "/config");
+    if(config.open(QIODevice::ReadOnly))
+    {
+        QByteArray content = config.readAll().toLower();
+        config.close();
+        if(content.contains("objectformat") && content.contains("sha256"))
+        {
+            hashSize = 32;
+        }
+    }
+    qRegisterMetaType<GitStatusScan>("GitStatusScan");
+    fileSystemWatcher->addPath(gitDir + "/index");
+    scan();
+}
+
+void GitStatus::indexChanged()
+{
+    //git replaces the index on every update, which drops it from the watcher
+    if(!fileSystemWatcher->files().contains(gitDir + "/index"))
+    {
+        fileSystemWatcher->addPath(gitDir + "/index");
+    }
+    fullScanPending = true;
+    timer->start();
+}
+
+void GitStatus::refresh(const QStringList &paths)
+{
+    if(root.isEmpty())
+    {
+        return;
+    }
+    for(int i = 0; i < paths.count(); i++)
+    {
+        if(paths[i].startsWith(root + "/"))
+        {
+            pendingPaths.insert(paths[i].mid(root.length() + 1));
+        }
+    }
+    if(!pendingPaths.isEmpty())
+    {
+        timer->start();
+    }
+}
+
+void GitStatus::scan()
+{
+    if(scanning || (!fullScanPending && pendingPaths.isEmpty()))
+    {
+        return;
+    }
+    if(!fullScanPending && index.isNull())
+    {
+        return; //the running full scan covers these paths
+    }
+    scanning = true;
+    GitStatusScanner *scanner;
+    if(fullScanPending)
+    {
+        scanner = new GitStatusScanner(root, gitDir, hashSize, QSharedPointer<GitIndex>(), QStringList());
+    }
+    else
+    {
+        scanner = new GitStatusScanner(root, gitDir, hashSize, index, pendingPaths.toList());
+    }
+    fullScanPending = false;
+    pendingPaths.clear();
+    connect(scanner, SIGNAL(scanned(GitStatusScan)), this, SLOT(scanned(GitStatusScan)));
+    QThreadPool::globalInstance()->start(scanner);
+}
+
+void GitStatus::scanned(GitStatusScan scan)
+{
+    scanning = false;
+    index = scan.index;
+    if(scan.full)
+    {
+        statuses = scan.statuses;
+    }
+    else
+    {
+        for(int i = 0; i < scan.paths.count(); i++)
+        {
+            statuses.remove(scan.paths[i]);
+        }
+        statuses.unite(scan.statuses);
+    }
+    dirtyDirs.clear();
+    for(QHash<QString, int>::const_iterator it = statuses.constBegin(); it != statuses.constEnd(); ++it)
+    {
+        const QString &path = it.key();
+        for(int slash = path.lastIndexOf('/'); slash > 0; slash = path.lastIndexOf('/', slash - 1))
+        {
+            QString dir = path.left(slash);
+            if(dirtyDirs.contains(dir))
+            {
+                break;
+            }
+            dirtyDirs.insert(dir);
+        }
+    }
+    emit changed();
+    if(fullScanPending || !pendingPaths.isEmpty())
+    {
+        timer->start();
+    }
+}
+
+GitStatus::Status GitStatus::status(const QString &path, bool isDir) const
+{
+    if(root.isEmpty() || index.isNull() || !path.startsWith(root + "/"))
+    {
+        return Clean;
+    }
+    QString relativePath = path.mid(root.length() + 1);
+    if(isDir)
+    {
+        if(dirtyDirs.contains(relativePath))
+        {
+            return Modified;
+        }
+        if(index->dirs.contains(relativePath))
+        {
+            return Clean;
+        }
+    }
+    else
+    {
+        QHash<QString, int>::const_iterator it = statuses.constFind(relativePath);
+        if(it != statuses.constEnd())
+        {
+            return (Status)it.value();
+        }
+        if(index->entries.contains(relativePath))
+        {
+            return Clean;
+        }
+    }
+    //not tracked at all
+    return GitIgnore::instance()->isIgnored(path, isDir) ? Ignored : Untracked;
+}
+
+GitStatusDelegate::GitStatusDelegate(QObject *parent, GitStatus *gitStatus) : QStyledItemDelegate(parent)
+{
+    this->gitStatus = gitStatus;
+}
+
+void GitStatusDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    QStyledItemDelegate::paint(painter, option, index);
+    QFileSystemModel *fileSystemModel = (QFileSystemModel*)index.model();
+    GitStatus::Status status = gitStatus->status(fileSystemModel->filePath(index), fileSystemModel->isDir(index));
+    QString marker;
+    QColor color;
+    if(status == GitStatus::Modified)
+    {
+        marker = "M";
+        color = QColor("#e2c08d");
+    }
+    else if(status == GitStatus::Untracked)
+    {
+        marker = "U";
+        color = QColor("#73c991");
+    }
+    else
+    {
+        return; //ignored entries are already dimmed by the model
+    }
+    painter->save();
+    painter->setPen(color);
+    painter->drawText(option.rect.adjusted(0, 0, -4, 0), Qt::AlignRight | Qt::AlignVCenter, marker);
+    painter->restore();
+}
@@ -0,0 +1,108 @@
+#ifndef GITSTATUS_H
+#define GITSTATUS_H
+
+
+#include <QtWidgets>
+
+//one stage 0 entry of .git/index
+struct GitIndexEntry
+{
+    qint64 mtime;
+    qint64 size;
+    QByteArray hash;
+    bool conflicted;
+    bool skipWorktree;
+};
+
+//parsed from the memory mapped index file, versions 2 to 4
+class GitIndex
+{
+public:
+    static QSharedPointer<GitIndex> read(const QString &filePath, int hashSize);
+    QHash<QString, GitIndexEntry> entries;
+    QSet<QString> dirs;
+    qint64 modified;
+};
+
+struct GitStatusScan
+{
+    QSharedPointer<GitIndex> index;
+    QHash<QString, int> statuses;
+    QStringList paths;
+    bool full;
+};
+
+Q_DECLARE_METATYPE(GitStatusScan)
+
+//compares index entries with the working tree; file contents are only hashed when the stat data can't tell
+class GitStatusScanner : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+signals:
+    void scanned(GitStatusScan scan);
+
+public:
+    GitStatusScanner(const QString &root, const QString &gitDir, int hashSize, QSharedPointer<GitIndex> index, const QStringList &paths);
+    void run();
+
+private:
+    int check(const QString &relativePath, const GitIndexEntry &entry, qint64 indexModified);
+    QByteArray blobHash(const QString &filePath, qint64 size);
+    QString root;
+    QString gitDir;
+    QSharedPointer<GitIndex> index;
+    QStringList paths;
+    int hashSize;
+};
+
+class GitStatus : public QObject
+{
+    Q_OBJECT
+
+signals:
+    void changed();
+
+public:
+    enum Status
+    {
+        Clean,
+        Modified,
+        Untracked,
+        Ignored
+    };
+    GitStatus(QObject *parent, const QString &folderPath);
+    Status status(const QString &path, bool isDir) const;
+    void refresh(const QStringList &paths);
+
+private slots:
+    void indexChanged();
+    void scan();
+    void scanned(GitStatusScan scan);
+
+private:
+    QString root;
+    QString gitDir;
+    int hashSize;
+    QSharedPointer<GitIndex> index;
+    QHash<QString, int> statuses;
+    QSet<QString> dirtyDirs;
+    QSet<QString> pendingPaths;
+    bool fullScanPending;
+    bool scanning;
+    QTimer *timer;
+    QFileSystemWatcher *fileSystemWatcher;
+};
+
+class GitStatusDelegate : public QStyledItemDelegate
+{
+public:
+    GitStatusDelegate(QObject *parent, GitStatus *gitStatus);
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const;
+
+private:
+    GitStatus *gitStatus;
+};
+
+
+#endif // GITSTATUS_H
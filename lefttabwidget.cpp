@@ -2,6 +2,8 @@
 #include "treeview.h"
 #include "tabbar.h"
 #include "mainwindow.h"
+#include "wordindex.h"
+#include "symbolindex.h"
 
 LeftTabWidget::LeftTabWidget(QWidget *parent) : QTabWidget(parent)
 {
@@ -13,6 +15,8 @@ LeftTabWidget::LeftTabWidget(QWidget *parent) : QTabWidget(parent)
 
 void LeftTabWidget::close(int index)
 {
+    WordIndex::instance()->removeFolder(this->tabToolTip(index));
+    SymbolIndex::instance()->removeFolder(this->tabToolTip(index));
     this->removeTab(index);
 }
 
@@ -38,4 +42,6 @@ void LeftTabWidget::showFolderTree(QString folderPath)
     treeView->setFocus();
     this->setTabToolTip(index, folderPath);
     this->setCurrentIndex(index);
+    WordIndex::instance()->addFolder(folderPath);
+    SymbolIndex::instance()->addFolder(folderPath);
 }
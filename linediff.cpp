@@ -0,0 +1,195 @@
+#include "linediff.h"
+
+const int LineDiff::MaxEditDistance;
+
+static int lineId(QHash<QString, int> &ids, const QString &line)
+{
+    QHash<QString, int>::const_iterator i = ids.constFind(line);
+    if(i != ids.constEnd())
+    {
+        return i.value();
+    }
+    int id = ids.count();
+    ids.insert(line, id);
+    return id;
+}
+
+QList<DiffHunk> LineDiff::diff(const QStringList &oldLines, const QStringList &newLines)
+{
+    QList<DiffHunk> hunks;
+
+    //fast path: most reloads only touch a few lines in the middle
+    int oldCount = oldLines.count();
+    int newCount = newLines.count();
+    int prefix = 0;
+    while(prefix < oldCount && prefix < newCount && oldLines.at(prefix) == newLines.at(prefix))
+    {
+        prefix++;
+    }
+    int suffix = 0;
+    while(suffix < oldCount - prefix && suffix < newCount - prefix && oldLines.at(oldCount - 1 - suffix) == newLines.at(newCount - 1 - suffix))
+    {
+        suffix++;
+    }
+    if(prefix + suffix == oldCount && prefix + suffix == newCount)
+    {
+        return hunks;
+    }
+
+    //lines are hashed to ids once, the diff itself only compares integers
+    QHash<QString, int> ids;
+    QVector<int> a(oldCount - prefix - suffix);
+    QVector<int> b(newCount - prefix - suffix);
+    for(int i = 0; i < a.size(); i++)
+    {
+        a[i] = lineId(ids, oldLines.at(prefix + i));
+    }
+    for(int i = 0; i < b.size(); i++)
+    {
+        b[i] = lineId(ids, newLines.at(prefix + i));
+    }
+    myers(a, b, prefix, hunks);
+    return hunks;
+}
+
+void LineDiff::myers(const QVector<int> &a, const QVector<int> &b, int offset, QList<DiffHunk> &hunks)
+{
+    int n = a.size();
+    int m = b.size();
+    int max = qMin(n + m, MaxEditDistance);
+    QVector<int> v(2 * max + 2, 0);
+    QList<QVector<int> > trace;
+    int d;
+    bool found = false;
+    for(d = 0; d <= max && !found; d++)
+    {
+        trace << v.mid(max - d, 2 * d + 1); //only diagonals -d..d can be read back
+        for(int k = -d; k <= d; k += 2)
+        {
+            int x;
+            if(k == -d || (k != d && v[max + k - 1] < v[max + k + 1]))
+            {
+                x = v[max + k + 1];
+            }
+            else
+            {
+                x = v[max + k - 1] + 1;
+            }
+            int y = x - k;
+            while(x < n && y < m && a[x] == b[y])
+            {
+                x++;
+                y++;
+            }
+            v[max + k] = x;
+            if(x >= n && y >= m)
+            {
+                found = true;
+                break;
+            }
+        }
+    }
+    if(!found)
+    {
+        //too different to be worth a minimal script, replace the whole middle
+        DiffHunk hunk = { offset, n, offset, m };
+        hunks << hunk;
+        return;
+    }
+
+    //walk the trace backwards, collecting runs of deleted and inserted lines
+    QList<DiffHunk> reversed;
+    int x = n;
+    int y = m;
+    for(d = trace.count() - 1; d > 0; d--)
+    {
+        const QVector<int> &previous = trace.at(d);
+        int k = x - y;
+        int previousK;
+        if(k == -d || (k != d && previous[d + k - 1] < previous[d + k + 1]))
+        {
+            previousK = k + 1;
+        }
+        else
+        {
+            previousK = k - 1;
+        }
+        int previousX = previous[d + previousK];
+        int previousY = previousX - previousK;
+        while(x > previousX && y > previousY)
+        {
+            x--;
+            y--;
+        }
+        DiffHunk hunk;
+        if(x == previousX) //insertion of b[previousY]
+        {
+            hunk.oldStart = x;
+            hunk.oldCount = 0;
+            hunk.newStart = previousY;
+            hunk.newCount = 1;
+        }
+        else //deletion of a[previousX]
+        {
+            hunk.oldStart = previousX;
+            hunk.oldCount = 1;
+            hunk.newStart = y;
+            hunk.newCount = 0;
+        }
+        if(!reversed.isEmpty() && reversed.last().oldStart == hunk.oldStart + hunk.oldCount && reversed.last().newStart == hunk.newStart + hunk.newCount)
+        {
+            DiffHunk &last = reversed.last();
+            last.oldStart = hunk.oldStart;
+            last.oldCount += hunk.oldCount;
+            last.newStart = hunk.newStart;
+            last.newCount += hunk.newCount;
+        }
+        else
+        {
+            reversed << hunk;
+        }
+        x = previousX;
+        y = previousY;
+    }
+    for(int i = reversed.count() - 1; i >= 0; i--)
+    {
+        DiffHunk hunk = reversed.at(i);
+        hunk.oldStart += offset;
+        hunk.newStart += offset;
+        hunks << hunk;
+    }
+}
+
+QVariantList LineDiff::edits(const QStringList &oldLines, const QStringList &newLines, const QList<DiffHunk> &hunks)
+{
+    //[startRow, startColumn, endRow, endColumn, text] replacements, last hunk first so rows stay valid
+    QVariantList edits;
+    int lastRow = oldLines.count() - 1;
+    for(int i = hunks.count() - 1; i >= 0; i--)
+    {
+        const DiffHunk &hunk = hunks.at(i);
+        QStringList inserted = newLines.mid(hunk.newStart, hunk.newCount);
+        QVariantList edit;
+        if(hunk.oldStart + hunk.oldCount <= lastRow)
+        {
+            QString text = inserted.join("\n");
+            if(!inserted.isEmpty())
+            {
+                text += "\n";
+            }
+            edit << hunk.oldStart << 0 << hunk.oldStart + hunk.oldCount << 0 << text;
+        }
+        else if(hunk.oldStart > 0)
+        {
+            //the hunk reaches the last line, which has no newline of its own to replace
+            QString text = inserted.isEmpty() ? QString() : "\n" + inserted.join("\n");
+            edit << hunk.oldStart - 1 << oldLines.at(hunk.oldStart - 1).length() << lastRow << oldLines.at(lastRow).length() << text;
+        }
+        else
+        {
+            edit << 0 << 0 << lastRow << oldLines.at(lastRow).length() << inserted.join("\n");
+        }
+        edits << QVariant(edit);
+    }
+    return edits;
+}
@@ -0,0 +1,28 @@
+#ifndef LINEDIFF_H
+#define LINEDIFF_H
+
+
+#include <QtCore>
+
+//lines [oldStart, oldStart + oldCount) of the old text became [newStart, newStart + newCount) of the new one
+struct DiffHunk
+{
+    int oldStart;
+    int oldCount;
+    int newStart;
+    int newCount;
+};
+
+class LineDiff
+{
+public:
+    static QList<DiffHunk> diff(const QStringList &oldLines, const QStringList &newLines);
+    static QVariantList edits(const QStringList &oldLines, const QStringList &newLines, const QList<DiffHunk> &hunks);
+    static const int MaxEditDistance = 2048;
+
+private:
+    static void myers(const QVector<int> &a, const QVector<int> &b, int offset, QList<DiffHunk> &hunks);
+};
+
+
+#endif // LINEDIFF_H
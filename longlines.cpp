@@ -0,0 +1,168 @@
+#include "longlines.h"
+#include "textbuffer.h"
+
+const int LongLines::SafeModeColumns;
+const int LongLines::ChunkColumns;
+const int LongLines::WrapColumns;
+
+//lines end at \n, \r\n or a lone \r, as in TextBuffer::splitLines
+int LongLines::maxLineLength(const QString &text)
+{
+    int maxLength = 0;
+    int start = 0;
+    const QChar *data = text.constData();
+    int length = text.length();
+    for(int i = 0; i < length; i++)
+    {
+        ushort c = data[i].unicode();
+        if(c == '\n' || c == '\r')
+        {
+            maxLength = qMax(maxLength, i - start);
+            start = i + 1;
+        }
+    }
+    return qMax(maxLength, length - start);
+}
+
+//rowBreaks gets one entry per row, the text joining it to the next row: empty where the row was
+//split off a longer line, the line's original terminator otherwise
+QString LongLines::chunk(const QString &text, QStringList *rowBreaks)
+{
+    rowBreaks->clear();
+    QStringList terminators;
+    QStringList lines = TextBuffer::splitLines(text, &terminators);
+    QString rows;
+    rows.reserve(text.length() + text.length() / ChunkColumns + 1);
+    for(int l = 0; l < lines.count(); l++)
+    {
+        const QString &line = lines.at(l);
+        int start = 0;
+        while(line.length() - start > ChunkColumns)
+        {
+            //split after a separator near the end of the chunk when there is one
+            int split = start + ChunkColumns;
+            for(int i = split; i > split - ChunkColumns / 10; i--)
+            {
+                QChar c = line.at(i - 1);
+                if(c == ',' || c == ';' || c == ' ' || c == '{' || c == '}' || c == '>')
+                {
+                    split = i;
+                    break;
+                }
+            }
+            if(line.at(split - 1).isHighSurrogate())
+            {
+                split--;
+            }
+            rows += line.midRef(start, split - start);
+            rows += '\n';
+            rowBreaks->append(QString());
+            start = split;
+        }
+        rows += line.midRef(start);
+        rowBreaks->append(terminators.at(l));
+        if(l < lines.count() - 1)
+        {
+            rows += '\n';
+        }
+    }
+    return rows;
+}
+
+QString LongLines::join(const QStringList &rows, const QStringList &rowBreaks)
+{
+    QString text;
+    for(int i = 0; i < rows.count(); i++)
+    {
+        text += rows.at(i);
+        if(i < rows.count() - 1)
+        {
+            text += i < rowBreaks.count() ? rowBreaks.at(i) : QString(QLatin1Char('\n'));
+        }
+    }
+    return text;
+}
+
+PrettyPrinter::PrettyPrinter(const QString &text)
+{
+    this->text = text;
+}
+
+void PrettyPrinter::run()
+{
+    QString output;
+    output.reserve(text.length() * 2);
+    int depth = 0;
+    bool inString = false;
+    const QChar *data = text.constData();
+    int length = text.length();
+    for(int i = 0; i < length; i++)
+    {
+        QChar c = data[i];
+        if(inString)
+        {
+            output += c;
+            if(c == '\\' && i + 1 < length)
+            {
+                output += data[++i];
+            }
+            else if(c == '"')
+            {
+                inString = false;
+            }
+            continue;
+        }
+        switch(c.unicode())
+        {
+        case ' ':
+        case '\t':
+        case '\r':
+        case '\n':
+            break;
+        case '"':
+            inString = true;
+            output += c;
+            break;
+        case '{':
+        case '[':
+        {
+            output += c;
+            //empty containers stay on one line
+            int next = i + 1;
+            while(next < length && data[next].isSpace())
+            {
+                next++;
+            }
+            if(next < length && (data[next] == '}' || data[next] == ']'))
+            {
+                output += data[next];
+                i = next;
+                break;
+            }
+            depth++;
+            output += '\n';
+            output += QString(depth * 4, ' ');
+            break;
+        }
+        case '}':
+        case ']':
+            depth = qMax(0, depth - 1);
+            output += '\n';
+            output += QString(depth * 4, ' ');
+            output += c;
+            break;
+        case ',':
+            output += c;
+            output += '\n';
+            output += QString(depth * 4, ' ');
+            break;
+        case ':':
+            output += ": ";
+            break;
+        default:
+            output += c;
+        }
+    }
+    output += '\n';
+    emit finished(output);
+}
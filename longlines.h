@@ -0,0 +1,37 @@
+#ifndef LONGLINES_H
+#define LONGLINES_H
+
+
+#include <QtCore>
+
+//minified and single-line files: Ace tokenizes and renders a document line in one piece,
+//so lines longer than SafeModeColumns are shown split into rows of ChunkColumns characters
+class LongLines
+{
+public:
+    static int maxLineLength(const QString &text);
+    static QString chunk(const QString &text, QStringList *rowBreaks);
+    static QString join(const QStringList &rows, const QStringList &rowBreaks);
+    static const int SafeModeColumns = 10000;
+    static const int ChunkColumns = 2000;
+    static const int WrapColumns = 200;
+};
+
+//reindents JSON without parsing it into objects, so key order, numbers and invalid input survive
+class PrettyPrinter : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+signals:
+    void finished(QString text);
+
+public:
+    PrettyPrinter(const QString &text);
+    void run();
+
+private:
+    QString text;
+};
+
+
+#endif // LONGLINES_H
@@ -1,9 +1,53 @@
 #include "mainwindow.h"
+#include "singleinstance.h"
+#include "whitespacenormalizer.h"
+#include "typingbenchmark.h"
 
 int main(int argc, char *argv[])
 {
+    if(argc == 3 && QString(argv[1]) == "--normalize")
+    {
+        QCoreApplication app(argc, argv);
+        return WhitespaceNormalizer::normalizeFolder(QString::fromLocal8Bit(argv[2]));
+    }
+    if(argc >= 2 && QString(argv[1]) == "--benchmark-typing")
+    {
+        QApplication app(argc, argv);
+        QStringList fixtures;
+        for(int i = 2; i < argc; i++)
+        {
+            fixtures << QString::fromLocal8Bit(argv[i]);
+        }
+        TypingBenchmark typingBenchmark(fixtures);
+        QTimer::singleShot(0, &typingBenchmark, SLOT(start()));
+        return app.exec();
+    }
+
+    //paths are made absolute here because the running instance has its own working directory
+    QStringList paths;
+    for(int i = 1; i < argc; i++)
+    {
+        QString argument = QString::fromLocal8Bit(argv[i]);
+        if(!argument.startsWith("-"))
+        {
+            paths << QFileInfo(argument).absoluteFilePath();
+        }
+    }
+    //a launch without paths still goes to the running instance, which raises its window
+    {
+        QCoreApplication app(argc, argv);
+        if(SingleInstance::forward(paths))
+        {
+            return 0;
+        }
+    }
+
     QApplication app(argc, argv);
+    SingleInstance singleInstance;
+    singleInstance.listen();
     MainWindow *mainWindow = new MainWindow();
+    QObject::connect(&singleInstance, SIGNAL(pathsReceived(QStringList)), mainWindow, SLOT(openPaths(QStringList)));
     mainWindow->show();
+    mainWindow->openPaths(paths);
     return app.exec();
 }
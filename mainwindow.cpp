@@ -5,6 +5,14 @@
 #include "webview.h"
 #include "treeview.h"
 #include "findfiledialog.h"
+#include "findsymboldialog.h"
+#include "symbolindex.h"
+#include "runnerpanel.h"
+#include "replacedialog.h"
+#include "resourcemonitor.h"
+#include "bridgemonitor.h"
+#include "outlinepanel.h"
+#include "markdownpreview.h"
 
 MainWindow::MainWindow()
 {
@@ -36,6 +44,26 @@ MainWindow::MainWindow()
     connect(findFileAction, SIGNAL(triggered()), this, SLOT(findFile()));
     this->addAction(findFileAction);
 
+    QAction *findSymbolAction = new QAction(tr("Find &Symbol"), this);
+    findSymbolAction->setShortcut(QKeySequence(tr("Ctrl+Shift+R", "File|Find Symbol")));
+    connect(findSymbolAction, SIGNAL(triggered()), this, SLOT(findSymbol()));
+    this->addAction(findSymbolAction);
+
+    QAction *replaceInFolderAction = new QAction(tr("&Replace in Folder"), this);
+    replaceInFolderAction->setShortcut(QKeySequence(tr("Ctrl+Shift+H", "Edit|Replace in Folder")));
+    connect(replaceInFolderAction, SIGNAL(triggered()), this, SLOT(replaceInFolder()));
+    this->addAction(replaceInFolderAction);
+
+    QAction *goToDefinitionAction = new QAction(tr("Go to &Definition"), this);
+    goToDefinitionAction->setShortcut(QKeySequence(tr("F12", "Edit|Go to Definition")));
+    connect(goToDefinitionAction, SIGNAL(triggered()), this, SLOT(goToDefinition()));
+    this->addAction(goToDefinitionAction);
+
+    QAction *splitAction = new QAction(tr("&Split Editor"), this);
+    splitAction->setShortcut(QKeySequence(tr("Ctrl+\\", "View|Split Editor")));
+    connect(splitAction, SIGNAL(triggered()), this, SLOT(toggleSplit()));
+    this->addAction(splitAction);
+
     //tool bar
     QToolBar *toolBar = new QToolBar(tr("&File"), this);
     toolBar->setObjectName("fileToolBar");
@@ -57,10 +85,8 @@ MainWindow::MainWindow()
     //right panel
     rightTabWidget = new RightTabWidget(this);
     connect(this, SIGNAL(openFileRequested(QString)), rightTabWidget, SLOT(open(QString)));
-    connect(this, SIGNAL(deleteFileRequested(QString)), rightTabWidget, SLOT(remove(QString)));
-    connect(this, SIGNAL(deleteFolderRequested(QString)), rightTabWidget, SLOT(removeFolder(QString)));
-    connect(this, SIGNAL(renameFileRequested(QString,QString)), rightTabWidget, SLOT(rename(QString, QString)));
-    connect(this, SIGNAL(renameFolderRequested(QString,QString)), rightTabWidget, SLOT(renameFolder(QString, QString)));
+    connect(this, SIGNAL(openFileAtLineRequested(QString,int)), rightTabWidget, SLOT(openAt(QString, int)));
+    connect(rightTabWidget, SIGNAL(tabsReleased(int, qint64)), this, SLOT(showReleasedMemory(int, qint64)));
 
     QAction *keyboardShortcutsAction = new QAction(tr("&Keyboard Shortcuts"), this);
     keyboardShortcutsAction->setIcon(QIcon(":/images/toolbar/preferences-desktop-keyboard-shortcuts.svg"));
@@ -77,6 +103,75 @@ MainWindow::MainWindow()
     //left panel
     leftTabWidget = new LeftTabWidget(this);
 
+    //file operations run in the background, progress shows in the status bar
+    fileOperationQueue = new FileOperationQueue(this);
+    connect(this, SIGNAL(fileOperationsRequested(QList<FileOperation>)), fileOperationQueue, SLOT(enqueue(QList<FileOperation>)));
+    connect(fileOperationQueue, SIGNAL(progress(int, int, QString)), this, SLOT(showFileOperationProgress(int, int, QString)));
+    connect(fileOperationQueue, SIGNAL(finished(QList<FileOperation>)), rightTabWidget, SLOT(applyFileOperations(QList<FileOperation>)));
+    connect(fileOperationQueue, SIGNAL(finished(QList<FileOperation>)), this, SLOT(fileOperationsFinished(QList<FileOperation>)));
+    progressBar = new QProgressBar(this);
+    progressBar->setMaximumWidth(160);
+    progressBar->setRange(0, 0);
+    progressBar->hide();
+    cancelButton = new QToolButton(this);
+    cancelButton->setText(tr("Cancel"));
+    cancelButton->hide();
+    connect(cancelButton, SIGNAL(clicked()), fileOperationQueue, SLOT(cancel()));
+    connect(fileOperationQueue, SIGNAL(started()), progressBar, SLOT(show()));
+    connect(fileOperationQueue, SIGNAL(started()), cancelButton, SLOT(show()));
+    this->statusBar()->addPermanentWidget(progressBar);
+    this->statusBar()->addPermanentWidget(cancelButton);
+
+    //bottom panel
+    QDockWidget *runnerDockWidget = new QDockWidget(tr("Run"), this);
+    runnerDockWidget->setObjectName("runnerDockWidget");
+    runnerDockWidget->setWidget(new RunnerPanel(runnerDockWidget, leftTabWidget));
+    runnerDockWidget->hide();
+    this->addDockWidget(Qt::BottomDockWidgetArea, runnerDockWidget);
+    QAction *runnerAction = runnerDockWidget->toggleViewAction();
+    runnerAction->setShortcut(QKeySequence(tr("Ctrl+Shift+B", "View|Run")));
+    this->addAction(runnerAction);
+
+    QDockWidget *resourceDockWidget = new QDockWidget(tr("Resources"), this);
+    resourceDockWidget->setObjectName("resourceDockWidget");
+    ResourceMonitor *resourceMonitor = new ResourceMonitor(resourceDockWidget, rightTabWidget);
+    resourceDockWidget->setWidget(resourceMonitor);
+    resourceDockWidget->hide();
+    this->addDockWidget(Qt::BottomDockWidgetArea, resourceDockWidget);
+    QAction *resourceAction = resourceDockWidget->toggleViewAction();
+    resourceAction->setShortcut(QKeySequence(tr("Ctrl+Shift+M", "View|Resources")));
+    this->addAction(resourceAction);
+    this->statusBar()->addWidget(resourceMonitor->summaryLabel());
+
+    QAction *dumpResourcesAction = new QAction(tr("Dump &Resource Snapshot"), this);
+    connect(dumpResourcesAction, SIGNAL(triggered()), resourceMonitor, SLOT(dump()));
+    this->addAction(dumpResourcesAction);
+
+    QDockWidget *outlineDockWidget = new QDockWidget(tr("Outline"), this);
+    outlineDockWidget->setObjectName("outlineDockWidget");
+    outlineDockWidget->setWidget(new OutlinePanel(outlineDockWidget, rightTabWidget));
+    outlineDockWidget->hide();
+    this->addDockWidget(Qt::RightDockWidgetArea, outlineDockWidget);
+    QAction *outlineAction = outlineDockWidget->toggleViewAction();
+    outlineAction->setShortcut(QKeySequence(tr("Ctrl+Shift+O", "View|Outline")));
+    this->addAction(outlineAction);
+
+    QDockWidget *markdownDockWidget = new QDockWidget(tr("Markdown Preview"), this);
+    markdownDockWidget->setObjectName("markdownDockWidget");
+    markdownDockWidget->setWidget(new MarkdownPreview(markdownDockWidget, rightTabWidget));
+    markdownDockWidget->hide();
+    this->addDockWidget(Qt::RightDockWidgetArea, markdownDockWidget);
+    QAction *markdownAction = markdownDockWidget->toggleViewAction();
+    markdownAction->setShortcut(QKeySequence(tr("Ctrl+Shift+V", "View|Markdown Preview")));
+    this->addAction(markdownAction);
+
+    BridgeHud *bridgeHud = new BridgeHud(this);
+    QAction *bridgeHudAction = new QAction(tr("Bridge &Latency HUD"), this);
+    bridgeHudAction->setCheckable(true);
+    bridgeHudAction->setShortcut(QKeySequence(tr("Ctrl+Shift+L", "View|Bridge Latency HUD")));
+    connect(bridgeHudAction, SIGNAL(toggled(bool)), bridgeHud, SLOT(setVisible(bool)));
+    this->addAction(bridgeHudAction);
+
     //layout
     splitter = new QSplitter(Qt::Horizontal);
     splitter->addWidget(leftTabWidget);
@@ -103,6 +198,58 @@ void MainWindow::findFile()
     findFileDialog->exec();
 }
 
+void MainWindow::findSymbol()
+{
+    FindSymbolDialog *findSymbolDialog = new FindSymbolDialog(QString());
+    findSymbolDialog->exec();
+}
+
+void MainWindow::replaceInFolder()
+{
+    int currentIndex = leftTabWidget->currentIndex();
+    if(currentIndex == -1)
+    {
+        return;
+    }
+    ReplaceDialog *replaceDialog = new ReplaceDialog(leftTabWidget->tabToolTip(currentIndex), rightTabWidget);
+    replaceDialog->setAttribute(Qt::WA_DeleteOnClose);
+    replaceDialog->show();
+}
+
+void MainWindow::toggleSplit()
+{
+    WebView *webView = qobject_cast<WebView*>(rightTabWidget->currentWidget());
+    if(webView == 0)
+    {
+        return;
+    }
+    webView->toggleSplit();
+}
+
+void MainWindow::goToDefinition()
+{
+    WebView *webView = qobject_cast<WebView*>(rightTabWidget->currentWidget());
+    if(webView == 0)
+    {
+        return;
+    }
+    QString word = webView->wordUnderCursor();
+    if(word.isEmpty())
+    {
+        return;
+    }
+    QList<Symbol> symbols = SymbolIndex::instance()->definitions(word);
+    if(symbols.count() == 1)
+    {
+        emit openFileAtLineRequested(symbols.first().filePath, symbols.first().line);
+    }
+    else if(symbols.count() > 1)
+    {
+        FindSymbolDialog *findSymbolDialog = new FindSymbolDialog(word);
+        findSymbolDialog->exec();
+    }
+}
+
 void MainWindow::openFolder()
 {
     QString folderPath = QFileDialog::getExistingDirectory(this, tr("Open Directory"), QDir::homePath(), QFileDialog::ShowDirsOnly | QFileDialog::DontResolveSymlinks);
@@ -112,14 +259,40 @@ void MainWindow::openFolder()
     }
 }
 
+void MainWindow::openPaths(QStringList paths)
+{
+    for(int i = 0; i < paths.count(); i++)
+    {
+        QFileInfo fileInfo(paths[i]);
+        if(fileInfo.isDir())
+        {
+            leftTabWidget->showFolderTree(fileInfo.absoluteFilePath());
+        }
+        else
+        {
+            emit openFileRequested(fileInfo.absoluteFilePath());
+        }
+    }
+    if(this->isMinimized())
+    {
+        this->showNormal();
+    }
+    this->raise();
+    this->activateWindow();
+}
+
+void MainWindow::showReleasedMemory(int count, qint64 freedBytes)
+{
+    this->statusBar()->showMessage(tr("Closed %n tab(s), %1 returned", "", count).arg(ResourceMonitor::formatBytes(freedBytes)), 5000);
+}
+
 void MainWindow::saveFile()
 {
-    QWidget *widget = rightTabWidget->currentWidget();
-    if(widget == 0)
+    WebView *webView = qobject_cast<WebView*>(rightTabWidget->currentWidget());
+    if(webView == 0)
     {
         return;
     }
-    WebView *webView = (WebView*)widget;
     webView->save();
 }
 
@@ -140,14 +313,44 @@ void MainWindow::keyboardShortcuts()
     QDesktopServices::openUrl(QUrl("https://github.com/ajaxorg/ace/wiki/Default-Keyboard-Shortcuts"));
 }
 
+void MainWindow::showFileOperationProgress(int done, int total, QString path)
+{
+    progressBar->setRange(0, total);
+    progressBar->setValue(done);
+    this->statusBar()->showMessage(path);
+}
+
+void MainWindow::fileOperationsFinished(QList<FileOperation> results)
+{
+    if(!fileOperationQueue->isBusy())
+    {
+        progressBar->hide();
+        cancelButton->hide();
+        this->statusBar()->clearMessage();
+    }
+    QStringList errors;
+    foreach(const FileOperation &operation, results)
+    {
+        if(!operation.succeeded)
+        {
+            errors << operation.error;
+        }
+    }
+    if(!errors.isEmpty())
+    {
+        QMessageBox::warning(this, tr("NeoEditor"), errors.join("\n"));
+    }
+}
+
 void MainWindow::closeEvent(QCloseEvent *closeEvent)
 {
     writeSettings();
+    QList<int> indexes;
     for(int i = rightTabWidget->count() - 1; i >= 0 ; i--)
     {
-        emit rightTabWidget->tabCloseRequested(i);
+        indexes << i;
     }
-    if(rightTabWidget->count() == 0)
+    if(rightTabWidget->closeTabs(indexes))
     {
         closeEvent->accept();
     }
@@ -5,6 +5,7 @@
 #include <QtWidgets>
 #include "lefttabwidget.h"
 #include "righttabwidget.h"
+#include "fileoperationqueue.h"
 
 class MainWindow : public QMainWindow
 {
@@ -12,25 +13,33 @@ class MainWindow : public QMainWindow
 
 signals:
     void openFileRequested(QString filePath);
-    void deleteFileRequested(QString filePath);
-    void deleteFolderRequested(QString folderPath);
-    void renameFileRequested(QString oldFilePath, QString newFilePath);
-    void renameFolderRequested(QString oldFolderPath, QString newFolderPath);
+    void openFileAtLineRequested(QString filePath, int line);
+    void fileOperationsRequested(QList<FileOperation> batch);
 
 public:
     MainWindow();
     static MainWindow* GetInstance();
 
+public slots:
+    void openPaths(QStringList paths);
+
 protected:
     void closeEvent(QCloseEvent *closeEvent);
 
 private slots:
     void findFile();
+    void findSymbol();
+    void replaceInFolder();
+    void goToDefinition();
+    void toggleSplit();
     void openFolder();
     void saveFile();
     void openFile(QModelIndex modelIndex);
     void about();
     void keyboardShortcuts();
+    void showFileOperationProgress(int done, int total, QString path);
+    void fileOperationsFinished(QList<FileOperation> results);
+    void showReleasedMemory(int count, qint64 freedBytes);
 
 private:
     void writeSettings();
@@ -38,6 +47,9 @@ private:
     QSplitter *splitter;
     LeftTabWidget *leftTabWidget;
     RightTabWidget *rightTabWidget;
+    FileOperationQueue *fileOperationQueue;
+    QProgressBar *progressBar;
+    QToolButton *cancelButton;
 };
 
 
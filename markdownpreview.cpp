@@ -0,0 +1,640 @@
+#include "markdownpreview.h"
+#include "righttabwidget.h"
+#include "webview.h"
+#include "textbuffer.h"
+#include "bridgemonitor.h"
+
+const int MarkdownPreview::RenderDelay;
+const int MarkdownPreview::SyncDelay;
+
+MarkdownRenderer::MarkdownRenderer(int version, const QStringList &lines, MarkdownDocumentPointer previous)
+{
+    this->version = version;
+    this->lines = lines;
+    this->previous = previous;
+    qRegisterMetaType<MarkdownDocumentPointer>("MarkdownDocumentPointer");
+}
+
+void MarkdownRenderer::run()
+{
+    //unchanged blocks keep their id and html, repeated blocks are matched in order
+    MarkdownDocumentPointer document(new MarkdownDocument());
+    document->nextId = 0;
+    QHash<QString, QList<int> > reusable;
+    if(!previous.isNull())
+    {
+        for(int i = 0; i < previous->blocks.count(); i++)
+        {
+            reusable[previous->blocks.at(i).source] << i;
+        }
+        document->nextId = previous->nextId;
+    }
+    foreach(const Source &source, split(lines, 0))
+    {
+        MarkdownBlock block;
+        block.source = source.lines.join("\n");
+        block.firstRow = source.firstRow;
+        QHash<QString, QList<int> >::iterator match = reusable.find(block.source);
+        if(match != reusable.end() && !match.value().isEmpty())
+        {
+            const MarkdownBlock &old = previous->blocks.at(match.value().takeFirst());
+            block.id = old.id;
+            block.html = old.html;
+            block.rendered = false;
+        }
+        else
+        {
+            block.id = document->nextId++;
+            block.html = renderBlock(source.lines);
+            block.rendered = true;
+        }
+        document->blocks << block;
+    }
+    emit rendered(version, document);
+}
+
+//blocks end at blank lines, fenced code runs to its closing fence and headings and rules stand alone
+QList<MarkdownRenderer::Source> MarkdownRenderer::split(const QStringList &lines, int firstRow)
+{
+    static const QRegularExpression heading("^ {0,3}#{1,6}(\\s|$)");
+    static const QRegularExpression underline("^ {0,3}(=+|-+)\\s*$");
+    static const QRegularExpression container("^ {0,3}([>*+-]|\\d{1,9}[.)])(\\s|$)|^(    |\\t)");
+    QList<Source> sources;
+    Source source;
+    source.firstRow = firstRow;
+    QString fence;
+    for(int row = 0; row < lines.count(); row++)
+    {
+        const QString &line = lines.at(row);
+        if(!fence.isNull())
+        {
+            source.lines << line;
+            QString closing = fenceOf(line);
+            if(!closing.isNull() && closing.at(0) == fence.at(0) && closing.length() >= fence.length() && line.trimmed() == closing)
+            {
+                fence = QString();
+                flush(sources, source);
+            }
+            continue;
+        }
+        if(line.trimmed().isEmpty())
+        {
+            flush(sources, source);
+            continue;
+        }
+        QString opening = fenceOf(line);
+        bool paragraph = !source.lines.isEmpty() && !container.match(source.lines.first()).hasMatch();
+        if(!opening.isNull())
+        {
+            flush(sources, source);
+            source.firstRow = firstRow + row;
+            source.lines << line;
+            fence = opening;
+        }
+        else if(paragraph && underline.match(line).hasMatch()) //setext heading
+        {
+            source.lines << line;
+            flush(sources, source);
+        }
+        else if(heading.match(line).hasMatch() || isRule(line))
+        {
+            flush(sources, source);
+            source.firstRow = firstRow + row;
+            source.lines << line;
+            flush(sources, source);
+        }
+        else
+        {
+            if(source.lines.isEmpty())
+            {
+                source.firstRow = firstRow + row;
+            }
+            source.lines << line;
+        }
+    }
+    flush(sources, source);
+    return sources;
+}
+
+void MarkdownRenderer::flush(QList<Source> &sources, Source &source)
+{
+    if(!source.lines.isEmpty())
+    {
+        sources << source;
+        source.lines.clear();
+    }
+}
+
+QString MarkdownRenderer::fenceOf(const QString &line)
+{
+    static const QRegularExpression fence("^ {0,3}(`{3,}|~{3,})");
+    QRegularExpressionMatch match = fence.match(line);
+    if(!match.hasMatch() || (match.captured(1).at(0) == '`' && line.indexOf('`', match.capturedEnd(1)) != -1))
+    {
+        return QString();
+    }
+    return match.captured(1);
+}
+
+bool MarkdownRenderer::isRule(const QString &line)
+{
+    static const QRegularExpression rule("^ {0,3}([-*_])(\\s*\\1){2,}\\s*$");
+    return rule.match(line).hasMatch();
+}
+
+QString MarkdownRenderer::renderBlock(const QStringList &lines)
+{
+    static const QRegularExpression heading("^ {0,3}(#{1,6})(?:\\s+(.*?))?(?:\\s+#+)?\\s*$");
+    static const QRegularExpression underline("^ {0,3}(=+|-+)\\s*$");
+    static const QRegularExpression quote("^ {0,3}> ?");
+    static const QRegularExpression indented("^(    |\\t)");
+    static const QRegularExpression marker("^ {0,3}([*+-]|\\d{1,9}[.)])(\\s|$)");
+    static const QRegularExpression delimiterRow("^\\s*\\|?\\s*:?-+:?\\s*(\\|\\s*:?-+:?\\s*)*\\|?\\s*$");
+    static const QRegularExpression indentation("^\\s+");
+    const QString &first = lines.first();
+    QString fence = fenceOf(first);
+    if(!fence.isNull())
+    {
+        QStringList code = lines.mid(1);
+        if(!code.isEmpty() && code.last().trimmed().startsWith(fence))
+        {
+            code.removeLast();
+        }
+        QString language = first.trimmed().mid(fence.length()).trimmed().section(' ', 0, 0);
+        QString attributes = language.isEmpty() ? QString() : " class=\"language-" + language.toHtmlEscaped() + "\"";
+        return "<pre><code" + attributes + ">" + code.join("\n").toHtmlEscaped() + "</code></pre>";
+    }
+    if(lines.count() == 1)
+    {
+        QRegularExpressionMatch match = heading.match(first);
+        if(match.hasMatch())
+        {
+            QString level = QString::number(match.captured(1).length());
+            return "<h" + level + ">" + renderInline(match.captured(2)) + "</h" + level + ">";
+        }
+        if(isRule(first))
+        {
+            return "<hr>";
+        }
+    }
+    if(quote.match(first).hasMatch())
+    {
+        QStringList inner;
+        foreach(QString line, lines)
+        {
+            inner << line.remove(quote);
+        }
+        QString html;
+        foreach(const Source &source, split(inner, 0))
+        {
+            html += renderBlock(source.lines);
+        }
+        return "<blockquote>" + html + "</blockquote>";
+    }
+    if(marker.match(first).hasMatch())
+    {
+        return renderList(lines);
+    }
+    bool code = true;
+    foreach(const QString &line, lines)
+    {
+        if(!indented.match(line).hasMatch())
+        {
+            code = false;
+            break;
+        }
+    }
+    if(code)
+    {
+        QStringList stripped;
+        foreach(QString line, lines)
+        {
+            stripped << line.remove(indented);
+        }
+        return "<pre><code>" + stripped.join("\n").toHtmlEscaped() + "</code></pre>";
+    }
+    if(lines.count() > 1 && first.contains('|') && delimiterRow.match(lines.at(1)).hasMatch() && cells(first).count() == cells(lines.at(1)).count())
+    {
+        return renderTable(lines);
+    }
+    if(lines.count() > 1 && underline.match(lines.last()).hasMatch())
+    {
+        QString level = lines.last().trimmed().startsWith('=') ? "1" : "2";
+        return "<h" + level + ">" + renderInline(lines.mid(0, lines.count() - 1).join("\n").trimmed()) + "</h" + level + ">";
+    }
+    QStringList text;
+    foreach(QString line, lines)
+    {
+        text << line.remove(indentation);
+    }
+    return "<p>" + renderInline(text.join("\n").trimmed()) + "</p>";
+}
+
+//continuation lines belong to the item above them, anything from a nested marker on is rendered as blocks
+QString MarkdownRenderer::renderList(const QStringList &lines)
+{
+    static const QRegularExpression marker("^(\\s*)([*+-]|(\\d{1,9})[.)])([ \\t]+|$)");
+    static const QRegularExpression task("^\\[([ xX])\\]\\s+");
+    QRegularExpressionMatch first = marker.match(lines.first());
+    bool ordered = !first.captured(3).isEmpty();
+    QList<QStringList> items;
+    int contentIndent = 0;
+    foreach(const QString &line, lines)
+    {
+        QRegularExpressionMatch match = marker.match(line);
+        if(match.hasMatch() && (items.isEmpty() || match.captured(1).length() < contentIndent))
+        {
+            contentIndent = match.capturedEnd(2) + 1;
+            items << QStringList(line.mid(match.capturedEnd()));
+        }
+        else
+        {
+            int spaces = 0;
+            while(spaces < contentIndent && spaces < line.length() && line.at(spaces).isSpace())
+            {
+                spaces++;
+            }
+            items.last() << line.mid(spaces);
+        }
+    }
+
+    QString html;
+    if(!ordered)
+    {
+        html = "<ul>";
+    }
+    else if(first.captured(3).toInt() == 1)
+    {
+        html = "<ol>";
+    }
+    else //lists split by blank lines keep their numbering
+    {
+        html = "<ol start=\"" + QString::number(first.captured(3).toInt()) + "\">";
+    }
+    foreach(const QStringList &item, items)
+    {
+        int nested = 1;
+        while(nested < item.count() && !marker.match(item.at(nested)).hasMatch() && fenceOf(item.at(nested)).isNull())
+        {
+            nested++;
+        }
+        QString text = item.mid(0, nested).join("\n").trimmed();
+        QRegularExpressionMatch checkbox = task.match(text);
+        if(checkbox.hasMatch())
+        {
+            html += QString("<li class=\"task\"><input type=\"checkbox\" disabled%1> ").arg(checkbox.captured(1) == " " ? "" : " checked");
+            text = text.mid(checkbox.capturedEnd());
+        }
+        else
+        {
+            html += "<li>";
+        }
+        html += renderInline(text);
+        foreach(const Source &source, split(item.mid(nested), 0))
+        {
+            html += renderBlock(source.lines);
+        }
+        html += "</li>";
+    }
+    return html + (ordered ? "</ol>" : "</ul>");
+}
+
+QString MarkdownRenderer::renderTable(const QStringList &lines)
+{
+    QStringList header = cells(lines.at(0));
+    QStringList alignments;
+    foreach(const QString &cell, cells(lines.at(1)))
+    {
+        bool left = cell.startsWith(':');
+        bool right = cell.endsWith(':');
+        alignments << (left && right ? " style=\"text-align: center\"" : right ? " style=\"text-align: right\"" : left ? " style=\"text-align: left\"" : "");
+    }
+    QString html = "<table><thead><tr>";
+    for(int column = 0; column < header.count(); column++)
+    {
+        html += "<th" + alignments.value(column) + ">" + renderInline(header.at(column)) + "</th>";
+    }
+    html += "</tr></thead><tbody>";
+    for(int row = 2; row < lines.count(); row++)
+    {
+        QStringList values = cells(lines.at(row));
+        html += "<tr>";
+        for(int column = 0; column < header.count(); column++)
+        {
+            html += "<td" + alignments.value(column) + ">" + renderInline(values.value(column)) + "</td>";
+        }
+        html += "</tr>";
+    }
+    return html + "</tbody></table>";
+}
+
+QStringList MarkdownRenderer::cells(const QString &line)
+{
+    //escaped pipes stay escaped for renderSpans
+    QString row = line.trimmed();
+    row.replace("\\|", QChar(1));
+    if(row.startsWith('|'))
+    {
+        row.remove(0, 1);
+    }
+    if(row.endsWith('|'))
+    {
+        row.chop(1);
+    }
+    QStringList cells;
+    foreach(QString cell, row.split('|'))
+    {
+        cells << cell.replace(QChar(1), "\\|").trimmed();
+    }
+    return cells;
+}
+
+//code spans first, their content is never formatted
+QString MarkdownRenderer::renderInline(const QString &text)
+{
+    QString html;
+    int position = 0;
+    int start = text.indexOf('`');
+    while(start != -1)
+    {
+        int ticks = 1;
+        while(start + ticks < text.length() && text.at(start + ticks) == '`')
+        {
+            ticks++;
+        }
+        QString run(ticks, '`');
+        int end = start + ticks;
+        forever
+        {
+            end = text.indexOf(run, end);
+            if(end == -1)
+            {
+                break;
+            }
+            int length = ticks;
+            while(end + length < text.length() && text.at(end + length) == '`')
+            {
+                length++;
+            }
+            if(length == ticks)
+            {
+                break;
+            }
+            end += length;
+        }
+        if(end == -1)
+        {
+            start = text.indexOf('`', start + ticks);
+            continue;
+        }
+        QString code = text.mid(start + ticks, end - start - ticks);
+        code.replace('\n', ' ');
+        if(code.length() > 2 && code.startsWith(' ') && code.endsWith(' ') && !code.trimmed().isEmpty())
+        {
+            code = code.mid(1, code.length() - 2);
+        }
+        html += renderSpans(text.mid(position, start - position));
+        html += "<code>" + code.toHtmlEscaped() + "</code>";
+        position = end + ticks;
+        start = text.indexOf('`', position);
+    }
+    return html + renderSpans(text.mid(position));
+}
+
+QString MarkdownRenderer::renderSpans(const QString &text)
+{
+    static const QString punctuation("!\"#$%&'()*+,-./:;<=>?@[\\]^_`{|}~");
+    static const QRegularExpression image("!\\[([^\\]]*)\\]\\(\\s*([^\\s)]+)(?:\\s+&quot;[^&]*&quot;)?\\s*\\)");
+    static const QRegularExpression link("\\[([^\\]]+)\\]\\(\\s*([^\\s)]*)(?:\\s+&quot;[^&]*&quot;)?\\s*\\)");
+    static const QRegularExpression autolink("&lt;((?:https?|ftp)://[^\\s&]+|mailto:[^\\s&]+)&gt;");
+    static const QRegularExpression script("(href|src)=\"\\s*(?:javascript|vbscript):", QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression strong("\\*\\*(?=\\S)(.+?)(?<=\\S)\\*\\*");
+    static const QRegularExpression underscoreStrong("(?<!\\w)__(?=\\S)(.+?)(?<=\\S)__(?!\\w)");
+    static const QRegularExpression emphasis("\\*(?=\\S)(.+?)(?<=\\S)\\*");
+    static const QRegularExpression underscoreEmphasis("(?<!\\w)_(?=\\S)(.+?)(?<=\\S)_(?!\\w)");
+    static const QRegularExpression strikethrough("~~(?=\\S)(.+?)(?<=\\S)~~");
+    static const QRegularExpression lineBreak("(?: {2,}|\\\\)\\n");
+
+    //backslash escapes become character references so none of the patterns below can match them
+    QString html;
+    html.reserve(text.length());
+    for(int i = 0; i < text.length(); i++)
+    {
+        QChar c = text.at(i);
+        if(c == '\\' && i + 1 < text.length() && punctuation.contains(text.at(i + 1)))
+        {
+            html += "&#" + QString::number(text.at(++i).unicode()) + ";";
+        }
+        else if(c == '&')
+        {
+            html += "&amp;";
+        }
+        else if(c == '<')
+        {
+            html += "&lt;";
+        }
+        else if(c == '>')
+        {
+            html += "&gt;";
+        }
+        else if(c == '"')
+        {
+            html += "&quot;";
+        }
+        else
+        {
+            html += c;
+        }
+    }
+    html.replace(image, "<img src=\"\\2\" alt=\"\\1\">");
+    html.replace(link, "<a href=\"\\2\">\\1</a>");
+    html.replace(autolink, "<a href=\"\\1\">\\1</a>");
+    html.replace(script, "\\1=\"#");
+    html.replace(strong, "<strong>\\1</strong>");
+    html.replace(underscoreStrong, "<strong>\\1</strong>");
+    html.replace(emphasis, "<em>\\1</em>");
+    html.replace(underscoreEmphasis, "<em>\\1</em>");
+    html.replace(strikethrough, "<del>\\1</del>");
+    html.replace(lineBreak, "<br>\n");
+    return html;
+}
+
+MarkdownPreview::MarkdownPreview(QWidget *parent, RightTabWidget *rightTabWidget) : QWidget(parent)
+{
+    this->rightTabWidget = rightTabWidget;
+    this->version = 0;
+    this->loaded = false;
+    this->rendering = false;
+    this->pending = false;
+    this->sourceRow = 0;
+    statusLabel = new QLabel(tr("Open a Markdown file to preview it"));
+    statusLabel->setAlignment(Qt::AlignCenter);
+    previewView = new QWebView();
+    previewView->setContextMenuPolicy(Qt::NoContextMenu);
+    previewView->page()->setLinkDelegationPolicy(QWebPage::DelegateAllLinks);
+    previewView->hide();
+    connect(previewView, SIGNAL(linkClicked(QUrl)), this, SLOT(openLink(QUrl)));
+    connect(previewView, SIGNAL(loadFinished(bool)), this, SLOT(pageLoaded(bool)));
+    previewView->load(QUrl("qrc:///html/markdown.html"));
+
+    //typing only restarts the timer, rendering happens on a worker once the edits pause
+    renderTimer = new QTimer(this);
+    renderTimer->setSingleShot(true);
+    renderTimer->setInterval(RenderDelay);
+    connect(renderTimer, SIGNAL(timeout()), this, SLOT(render()));
+
+    QVBoxLayout *layout = new QVBoxLayout();
+    layout->addWidget(statusLabel);
+    layout->addWidget(previewView);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->setSpacing(0);
+    this->setLayout(layout);
+
+    connect(rightTabWidget, SIGNAL(currentChanged(int)), this, SLOT(currentChanged(int)));
+}
+
+bool MarkdownPreview::isMarkdown(const QString &filePath)
+{
+    QString suffix = QFileInfo(CompressedFile::plainPath(filePath)).suffix().toLower();
+    return suffix == "md" || suffix == "markdown" || suffix == "mdown" || suffix == "mkd";
+}
+
+void MarkdownPreview::showEvent(QShowEvent *showEvent)
+{
+    QWidget::showEvent(showEvent);
+    render();
+}
+
+void MarkdownPreview::pageLoaded(bool ok)
+{
+    loaded = ok;
+    if(ok)
+    {
+        previewView->page()->mainFrame()->addToJavaScriptWindowObject("qt", this);
+        currentChanged(rightTabWidget->currentIndex());
+    }
+}
+
+void MarkdownPreview::currentChanged(int index)
+{
+    if(!webView.isNull())
+    {
+        disconnect(webView->buffer(), SIGNAL(changed(int, QStringList, QStringList)), renderTimer, SLOT(start()));
+        disconnect(webView, SIGNAL(viewportMoved(int, int)), this, SLOT(sourceScrolled(int, int)));
+    }
+    webView = qobject_cast<WebView*>(rightTabWidget->widget(index));
+    if(!webView.isNull() && !isMarkdown(webView->filePath()))
+    {
+        webView.clear();
+    }
+    //a render still in flight belongs to the previous tab
+    version++;
+    document.clear();
+    renderTimer->stop();
+    statusLabel->setVisible(webView.isNull());
+    previewView->setVisible(!webView.isNull());
+    if(webView.isNull())
+    {
+        return;
+    }
+    connect(webView->buffer(), SIGNAL(changed(int, QStringList, QStringList)), renderTimer, SLOT(start()));
+    connect(webView, SIGNAL(viewportMoved(int, int)), this, SLOT(sourceScrolled(int, int)));
+    sourceRow = webView->firstVisibleRow();
+    if(!loaded) //done again by pageLoaded
+    {
+        return;
+    }
+    //relative links and images resolve against the document's folder
+    call("resetPreview", QVariantList() << QUrl::fromLocalFile(QFileInfo(webView->filePath()).absolutePath() + "/").toString());
+    render();
+}
+
+void MarkdownPreview::render()
+{
+    if(!this->isVisible() || webView.isNull() || !loaded) //rendered by showEvent
+    {
+        return;
+    }
+    if(rendering)
+    {
+        pending = true;
+        return;
+    }
+    rendering = true;
+    pending = false;
+    MarkdownRenderer *renderer = new MarkdownRenderer(version, webView->buffer()->lines(), document);
+    connect(renderer, SIGNAL(rendered(int, MarkdownDocumentPointer)), this, SLOT(rendered(int, MarkdownDocumentPointer)));
+    QThreadPool::globalInstance()->start(renderer);
+}
+
+void MarkdownPreview::rendered(int version, MarkdownDocumentPointer document)
+{
+    rendering = false;
+    if(version == this->version)
+    {
+        //the page keeps the elements of blocks it already has, only new html crosses the bridge
+        QVariantList blocks;
+        foreach(const MarkdownBlock &block, document->blocks)
+        {
+            QVariantList entry;
+            entry << block.id << block.firstRow << (block.rendered ? QVariant(block.html) : QVariant());
+            blocks.append(QVariant(entry));
+        }
+        call("updatePreview", QVariantList() << QVariant(blocks));
+        this->document = document;
+        if(!previewScrollTimer.isValid() || previewScrollTimer.elapsed() >= SyncDelay)
+        {
+            call("scrollToRow", QVariantList() << sourceRow);
+        }
+    }
+    if(pending)
+    {
+        render();
+    }
+}
+
+void MarkdownPreview::sourceScrolled(int firstRow, int lastRow)
+{
+    Q_UNUSED(lastRow);
+    sourceRow = firstRow;
+    //the editor follows the preview while the preview is being scrolled, its echo is dropped
+    if(document.isNull() || !this->isVisible() || (previewScrollTimer.isValid() && previewScrollTimer.elapsed() < SyncDelay))
+    {
+        return;
+    }
+    call("scrollToRow", QVariantList() << firstRow);
+}
+
+void MarkdownPreview::previewScrolled(int row)
+{
+    previewScrollTimer.start();
+    sourceRow = row;
+    if(!webView.isNull())
+    {
+        webView->scrollToRow(row);
+    }
+}
+
+void MarkdownPreview::openLink(QUrl url)
+{
+    if(url.isLocalFile())
+    {
+        if(QFileInfo(url.toLocalFile()).isFile())
+        {
+            rightTabWidget->open(url.toLocalFile());
+        }
+    }
+    else if(url.scheme() == "http" || url.scheme() == "https" || url.scheme() == "mailto")
+    {
+        QDesktopServices::openUrl(url);
+    }
+}
+
+void MarkdownPreview::call(const char *function, const QVariantList &arguments)
+{
+    QString json = QString::fromUtf8(QJsonDocument::fromVariant(arguments).toJson(QJsonDocument::Compact));
+    json.replace(QChar(0x2028), "\\u2028").replace(QChar(0x2029), "\\u2029");
+    QString script = QString("%1.apply(null, %2);null;").arg(QString::fromLatin1(function), json);
+    BridgeTimer bridgeTimer(function, script.length() * sizeof(QChar));
+    previewView->page()->mainFrame()->evaluateJavaScript(script);
+}
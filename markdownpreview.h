@@ -0,0 +1,104 @@
+#ifndef MARKDOWNPREVIEW_H
+#define MARKDOWNPREVIEW_H
+
+
+#include <QtWebKitWidgets>
+
+class RightTabWidget;
+class WebView;
+
+//one block-level unit, its element in the preview page is kept for as long as its source is unchanged
+struct MarkdownBlock
+{
+    QString source;
+    int firstRow;
+    int id;
+    QString html;
+    bool rendered; //html was produced by this pass and is not in the page yet
+};
+
+class MarkdownDocument
+{
+public:
+    QList<MarkdownBlock> blocks;
+    int nextId;
+};
+
+typedef QSharedPointer<MarkdownDocument> MarkdownDocumentPointer;
+Q_DECLARE_METATYPE(MarkdownDocumentPointer)
+
+//splits a snapshot into blocks and renders only the ones the previous document does not have
+class MarkdownRenderer : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+signals:
+    void rendered(int version, MarkdownDocumentPointer document);
+
+public:
+    MarkdownRenderer(int version, const QStringList &lines, MarkdownDocumentPointer previous);
+    void run();
+    static QString renderBlock(const QStringList &lines);
+    static QString renderInline(const QString &text);
+
+private:
+    struct Source
+    {
+        int firstRow;
+        QStringList lines;
+    };
+    static QList<Source> split(const QStringList &lines, int firstRow);
+    static void flush(QList<Source> &sources, Source &source);
+    static QString fenceOf(const QString &line);
+    static bool isRule(const QString &line);
+    static QString renderList(const QStringList &lines);
+    static QString renderTable(const QStringList &lines);
+    static QStringList cells(const QString &line);
+    static QString renderSpans(const QString &text);
+    int version;
+    QStringList lines;
+    MarkdownDocumentPointer previous;
+};
+
+class MarkdownPreview : public QWidget
+{
+    Q_OBJECT
+
+public:
+    MarkdownPreview(QWidget *parent, RightTabWidget *rightTabWidget);
+    static bool isMarkdown(const QString &filePath);
+    static const int RenderDelay = 300;
+    static const int SyncDelay = 300;
+
+public slots:
+    void previewScrolled(int row);
+
+protected:
+    void showEvent(QShowEvent *showEvent);
+
+private slots:
+    void pageLoaded(bool ok);
+    void currentChanged(int index);
+    void render();
+    void rendered(int version, MarkdownDocumentPointer document);
+    void sourceScrolled(int firstRow, int lastRow);
+    void openLink(QUrl url);
+
+private:
+    void call(const char *function, const QVariantList &arguments);
+    RightTabWidget *rightTabWidget;
+    QPointer<WebView> webView;
+    QWebView *previewView;
+    QLabel *statusLabel;
+    QTimer *renderTimer;
+    MarkdownDocumentPointer document;
+    int version;
+    bool loaded;
+    bool rendering;
+    bool pending;
+    int sourceRow;
+    QElapsedTimer previewScrollTimer;
+};
+
+
+#endif // MARKDOWNPREVIEW_H
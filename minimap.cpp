@@ -0,0 +1,395 @@
+#include "minimap.h"
+#include "webview.h"
+#include "textbuffer.h"
+
+//monokai colors for the character classes the renderer tells apart; the classes come from a
+//per-character scan of the text rather than Ace's tokenizer, whose tokens only exist on the GUI
+//thread and only up to the rows it has reached, so the colors approximate the editor's for
+//modes with unusual comment or string syntax
+static const QRgb WordColor = qRgb(0xb8, 0xb8, 0xb2);
+static const QRgb PunctuationColor = qRgb(0xc9, 0x26, 0x72);
+static const QRgb NumberColor = qRgb(0x8e, 0x61, 0xdf);
+static const QRgb StringColor = qRgb(0xc6, 0xbb, 0x54);
+static const QRgb CommentColor = qRgb(0x65, 0x61, 0x4e);
+
+const int Minimap::Columns;
+const int Minimap::RowHeight;
+const int Minimap::TileRows;
+
+MinimapRenderer::MinimapRenderer(int id, int version, QStringList lines)
+{
+    this->id = id;
+    this->version = version;
+    this->lines = lines;
+}
+
+void MinimapRenderer::run()
+{
+    QImage image(Minimap::Columns, qMax(1, lines.count()) * Minimap::RowHeight, QImage::Format_ARGB32_Premultiplied);
+    image.fill(0);
+    for(int row = 0; row < lines.count(); row++)
+    {
+        QRgb *scanLine = (QRgb*)image.scanLine(row * Minimap::RowHeight);
+        const QString &line = lines.at(row);
+        const QChar *data = line.constData();
+        int length = line.length();
+        int column = 0;
+        ushort quote = 0;
+        bool escaped = false;
+        bool comment = false;
+        bool word = false;
+        for(int i = 0; i < length && column < Minimap::Columns; i++)
+        {
+            ushort c = data[i].unicode();
+            if(c == '\t')
+            {
+                column += 4 - column % 4;
+                word = false;
+                continue;
+            }
+            QRgb color;
+            if(comment)
+            {
+                color = CommentColor;
+            }
+            else if(quote != 0)
+            {
+                color = StringColor;
+                if(escaped)
+                {
+                    escaped = false;
+                }
+                else if(c == '\\')
+                {
+                    escaped = true;
+                }
+                else if(c == quote)
+                {
+                    quote = 0;
+                }
+            }
+            else if(c == '"' || c == '\'' || c == '`')
+            {
+                quote = c;
+                color = StringColor;
+            }
+            else if(c == '#' || (c == '/' && i + 1 < length && (data[i + 1].unicode() == '/' || data[i + 1].unicode() == '*')))
+            {
+                comment = true;
+                color = CommentColor;
+            }
+            else if(data[i].isLetter() || c == '_' || c == '$')
+            {
+                color = WordColor;
+                word = true;
+            }
+            else if(data[i].isDigit())
+            {
+                color = word ? WordColor : NumberColor;
+            }
+            else
+            {
+                color = PunctuationColor;
+                word = false;
+            }
+            if(!data[i].isSpace())
+            {
+                scanLine[column] = color;
+            }
+            else
+            {
+                word = false;
+            }
+            column++;
+        }
+    }
+    emit rendered(id, version, image);
+}
+
+Minimap::Minimap(WebView *webView, TextBuffer *textBuffer) : QWidget(webView)
+{
+    this->webView = webView;
+    this->textBuffer = textBuffer;
+    this->nextTileId = 0;
+    this->firstRow = 0;
+    this->lastRow = 0;
+    this->dragging = false;
+    this->dragOffset = 0;
+    this->setFixedWidth(Columns);
+    this->setAttribute(Qt::WA_OpaquePaintEvent);
+    this->setCursor(Qt::ArrowCursor);
+
+    renderTimer = new QTimer(this);
+    renderTimer->setSingleShot(true);
+    connect(renderTimer, SIGNAL(timeout()), this, SLOT(renderTiles()));
+
+    //scroll requests to Ace are coalesced to one per frame
+    scrollTimer = new QTimer(this);
+    scrollTimer->setSingleShot(true);
+    scrollTimer->setInterval(16);
+    connect(scrollTimer, SIGNAL(timeout()), this, SLOT(scroll()));
+
+    connect(textBuffer, SIGNAL(changed(int, QStringList, QStringList)), this, SLOT(change(int, QStringList, QStringList)));
+    appendTiles(tiles, 0, textBuffer->lineCount());
+    renderTimer->start();
+}
+
+void Minimap::appendTiles(QList<MinimapTile> &tiles, int firstRow, int rowCount)
+{
+    for(int row = firstRow; row < firstRow + rowCount; row += TileRows)
+    {
+        MinimapTile tile;
+        tile.id = nextTileId++;
+        tile.firstRow = row;
+        tile.rowCount = qMin(TileRows, firstRow + rowCount - row);
+        tile.version = 0;
+        tile.dirty = true;
+        tiles << tile;
+    }
+}
+
+void Minimap::change(int row, QStringList removedLines, QStringList insertedLines)
+{
+    int lineDelta = insertedLines.count() - removedLines.count();
+    int lastRemovedRow = row + removedLines.count() - 1;
+    int first = tiles.isEmpty() ? 0 : tileAt(row);
+    int last = tiles.isEmpty() ? -1 : tileAt(lastRemovedRow);
+
+    //only the tiles touched by the delta are redrawn, the ones below just move
+    QList<MinimapTile> newTiles = tiles.mid(0, first);
+    int regionFirstRow = first < tiles.count() ? tiles.at(first).firstRow : 0;
+    int regionRowCount = 0;
+    for(int i = first; i <= last; i++)
+    {
+        regionRowCount += tiles.at(i).rowCount;
+    }
+    regionRowCount += lineDelta;
+    if(tiles.isEmpty())
+    {
+        regionRowCount = textBuffer->lineCount();
+    }
+    appendTiles(newTiles, regionFirstRow, regionRowCount);
+    for(int i = last + 1; i < tiles.count(); i++)
+    {
+        MinimapTile tile = tiles.at(i);
+        tile.firstRow += lineDelta;
+        newTiles << tile;
+    }
+    tiles = newTiles;
+    if(lastRow >= textBuffer->lineCount())
+    {
+        lastRow = textBuffer->lineCount() - 1;
+    }
+    renderTimer->start();
+    this->update();
+}
+
+void Minimap::renderTiles()
+{
+    //visible tiles go to the pool first
+    int visibleFirstRow = scrollOffset() / RowHeight;
+    int visibleLastRow = visibleFirstRow + this->height() / RowHeight;
+    QList<int> visible;
+    QList<int> hidden;
+    for(int i = 0; i < tiles.count(); i++)
+    {
+        if(!tiles.at(i).dirty)
+        {
+            continue;
+        }
+        int tileFirstRow = tiles.at(i).firstRow;
+        int tileLastRow = tileFirstRow + tiles.at(i).rowCount - 1;
+        if(tileLastRow >= visibleFirstRow && tileFirstRow <= visibleLastRow)
+        {
+            visible << i;
+        }
+        else
+        {
+            hidden << i;
+        }
+    }
+    const QStringList &lines = textBuffer->lines();
+    foreach(int i, visible + hidden)
+    {
+        MinimapTile &tile = tiles[i];
+        tile.dirty = false;
+        tile.version++;
+        MinimapRenderer *renderer = new MinimapRenderer(tile.id, tile.version, lines.mid(tile.firstRow, tile.rowCount));
+        connect(renderer, SIGNAL(rendered(int, int, QImage)), this, SLOT(tileRendered(int, int, QImage)));
+        QThreadPool::globalInstance()->start(renderer);
+    }
+}
+
+void Minimap::tileRendered(int id, int version, QImage image)
+{
+    for(int i = 0; i < tiles.count(); i++)
+    {
+        if(tiles.at(i).id == id)
+        {
+            if(tiles.at(i).version == version)
+            {
+                tiles[i].image = image;
+                this->update();
+            }
+            return;
+        }
+    }
+}
+
+int Minimap::tileAt(int row) const
+{
+    int low = 0;
+    int high = tiles.count() - 1;
+    while(low < high)
+    {
+        int middle = (low + high + 1) / 2;
+        if(tiles.at(middle).firstRow <= row)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle - 1;
+        }
+    }
+    return low;
+}
+
+int Minimap::maxFirstRow() const
+{
+    return qMax(0, textBuffer->lineCount() - (lastRow - firstRow + 1));
+}
+
+int Minimap::scrollOffset() const
+{
+    //the minimap scrolls proportionally to the editor when the document is taller than the widget
+    int overflow = textBuffer->lineCount() * RowHeight - this->height();
+    if(overflow <= 0 || maxFirstRow() == 0)
+    {
+        return 0;
+    }
+    return (int)((qint64)overflow * qMin(firstRow, maxFirstRow()) / maxFirstRow());
+}
+
+void Minimap::setViewport(int firstRow, int lastRow)
+{
+    if(dragging)
+    {
+        return;
+    }
+    this->firstRow = firstRow;
+    this->lastRow = lastRow;
+    this->update();
+}
+
+void Minimap::paintEvent(QPaintEvent *paintEvent)
+{
+    QPainter painter(this);
+    QRect rect = paintEvent->rect();
+    painter.fillRect(rect, QColor(0x27, 0x28, 0x22));
+    if(tiles.isEmpty())
+    {
+        return;
+    }
+    int offset = scrollOffset();
+    for(int i = tileAt((offset + rect.top()) / RowHeight); i < tiles.count(); i++)
+    {
+        const MinimapTile &tile = tiles.at(i);
+        int y = tile.firstRow * RowHeight - offset;
+        if(y > rect.bottom())
+        {
+            break;
+        }
+        if(!tile.image.isNull())
+        {
+            painter.drawImage(0, y, tile.image);
+        }
+    }
+    painter.fillRect(0, firstRow * RowHeight - offset, this->width(), (lastRow - firstRow + 1) * RowHeight, QColor(255, 255, 255, 32));
+}
+
+void Minimap::mousePressEvent(QMouseEvent *mouseEvent)
+{
+    if(mouseEvent->button() != Qt::LeftButton)
+    {
+        return;
+    }
+    int offset = scrollOffset();
+    int viewportTop = firstRow * RowHeight - offset;
+    int viewportHeight = (lastRow - firstRow + 1) * RowHeight;
+    int y = mouseEvent->pos().y();
+    if(y >= viewportTop && y < viewportTop + viewportHeight)
+    {
+        dragOffset = y - viewportTop;
+    }
+    else
+    {
+        //jump so that the clicked row is centered, then keep dragging from there
+        int row = (y + offset) / RowHeight - (lastRow - firstRow) / 2;
+        int visibleRows = lastRow - firstRow;
+        firstRow = qBound(0, row, maxFirstRow());
+        lastRow = firstRow + visibleRows;
+        dragOffset = viewportHeight / 2;
+        scrollTimer->start();
+        this->update();
+    }
+    dragging = true;
+}
+
+void Minimap::mouseMoveEvent(QMouseEvent *mouseEvent)
+{
+    if(dragging)
+    {
+        dragTo(mouseEvent->pos().y());
+    }
+}
+
+void Minimap::mouseReleaseEvent(QMouseEvent *mouseEvent)
+{
+    if(dragging)
+    {
+        dragTo(mouseEvent->pos().y());
+        dragging = false;
+        scroll();
+    }
+}
+
+void Minimap::wheelEvent(QWheelEvent *wheelEvent)
+{
+    int visibleRows = lastRow - firstRow;
+    firstRow = qBound(0, firstRow - wheelEvent->angleDelta().y() / 40, maxFirstRow());
+    lastRow = firstRow + visibleRows;
+    scrollTimer->start();
+    this->update();
+}
+
+void Minimap::dragTo(int y)
+{
+    //while dragging, the viewport rectangle travels over [0, height - viewportHeight]
+    int visibleRows = lastRow - firstRow;
+    int viewportHeight = (visibleRows + 1) * RowHeight;
+    int travel = qMin(this->height(), textBuffer->lineCount() * RowHeight) - viewportHeight;
+    if(travel <= 0)
+    {
+        return;
+    }
+    int row = (int)((qint64)(y - dragOffset) * maxFirstRow() / travel);
+    row = qBound(0, row, maxFirstRow());
+    if(row == firstRow)
+    {
+        return;
+    }
+    firstRow = row;
+    lastRow = row + visibleRows;
+    if(!scrollTimer->isActive())
+    {
+        scrollTimer->start();
+    }
+    this->update();
+}
+
+void Minimap::scroll()
+{
+    scrollTimer->stop();
+    webView->scrollToRow(firstRow);
+}
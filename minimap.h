@@ -0,0 +1,81 @@
+#ifndef MINIMAP_H
+#define MINIMAP_H
+
+
+#include <QtWidgets>
+
+class WebView;
+class TextBuffer;
+
+//a run of consecutive document rows rendered into one image
+struct MinimapTile
+{
+    int id;
+    int firstRow;
+    int rowCount;
+    int version;
+    bool dirty;
+    QImage image;
+};
+
+class MinimapRenderer : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+signals:
+    void rendered(int id, int version, QImage image);
+
+public:
+    MinimapRenderer(int id, int version, QStringList lines);
+    void run();
+
+private:
+    int id;
+    int version;
+    QStringList lines;
+};
+
+class Minimap : public QWidget
+{
+    Q_OBJECT
+
+public:
+    Minimap(WebView *webView, TextBuffer *textBuffer);
+    void setViewport(int firstRow, int lastRow);
+    static const int Columns = 120;
+    static const int RowHeight = 2;
+    static const int TileRows = 128;
+
+protected:
+    void paintEvent(QPaintEvent *paintEvent);
+    void mousePressEvent(QMouseEvent *mouseEvent);
+    void mouseMoveEvent(QMouseEvent *mouseEvent);
+    void mouseReleaseEvent(QMouseEvent *mouseEvent);
+    void wheelEvent(QWheelEvent *wheelEvent);
+
+private slots:
+    void change(int row, QStringList removedLines, QStringList insertedLines);
+    void renderTiles();
+    void tileRendered(int id, int version, QImage image);
+    void scroll();
+
+private:
+    void appendTiles(QList<MinimapTile> &tiles, int firstRow, int rowCount);
+    int tileAt(int row) const;
+    int maxFirstRow() const;
+    int scrollOffset() const;
+    void dragTo(int y);
+    WebView *webView;
+    TextBuffer *textBuffer;
+    QList<MinimapTile> tiles;
+    int nextTileId;
+    int firstRow;
+    int lastRow;
+    bool dragging;
+    int dragOffset;
+    QTimer *renderTimer;
+    QTimer *scrollTimer;
+};
+
+
+#endif // MINIMAP_H
@@ -0,0 +1,101 @@
+#include "outlinepanel.h"
+#include "righttabwidget.h"
+#include "webview.h"
+#include "structureindex.h"
+
+OutlinePanel::OutlinePanel(QWidget *parent, RightTabWidget *rightTabWidget) : QWidget(parent)
+{
+    this->rightTabWidget = rightTabWidget;
+    treeWidget = new QTreeWidget();
+    treeWidget->setHeaderHidden(true);
+    treeWidget->setUniformRowHeights(true);
+    connect(treeWidget, SIGNAL(itemActivated(QTreeWidgetItem*, int)), this, SLOT(activate(QTreeWidgetItem*)));
+    statusLabel = new QLabel();
+    statusLabel->setWordWrap(true);
+
+    QVBoxLayout *layout = new QVBoxLayout();
+    layout->addWidget(statusLabel);
+    layout->addWidget(treeWidget);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->setSpacing(0);
+    this->setLayout(layout);
+
+    connect(rightTabWidget, SIGNAL(currentChanged(int)), this, SLOT(currentChanged(int)));
+}
+
+void OutlinePanel::showEvent(QShowEvent *showEvent)
+{
+    QWidget::showEvent(showEvent);
+    refresh();
+}
+
+void OutlinePanel::currentChanged(int index)
+{
+    if(!webView.isNull())
+    {
+        disconnect(webView, SIGNAL(structureChanged()), this, SLOT(refresh()));
+    }
+    webView = qobject_cast<WebView*>(rightTabWidget->widget(index));
+    if(!webView.isNull())
+    {
+        connect(webView, SIGNAL(structureChanged()), this, SLOT(refresh()));
+    }
+    refresh();
+}
+
+void OutlinePanel::refresh()
+{
+    if(!this->isVisible()) //rebuilt by showEvent
+    {
+        return;
+    }
+    treeWidget->clear();
+    StructureIndexPointer structureIndex;
+    if(!webView.isNull())
+    {
+        structureIndex = webView->structure();
+    }
+    if(structureIndex.isNull())
+    {
+        statusLabel->setText(tr("No outline for this document"));
+        return;
+    }
+    if(structureIndex->error.isNull())
+    {
+        statusLabel->setText(tr("Well-formed"));
+    }
+    else
+    {
+        statusLabel->setText(tr("Line %1, column %2: %3").arg(structureIndex->errorRow + 1).arg(structureIndex->errorColumn + 1).arg(structureIndex->error));
+    }
+
+    //parents always come before their children
+    const QList<OutlineNode> &outline = structureIndex->outline;
+    QVector<QTreeWidgetItem*> items(outline.count());
+    QList<QTreeWidgetItem*> topLevelItems;
+    for(int i = 0; i < outline.count(); i++)
+    {
+        const OutlineNode &node = outline.at(i);
+        QTreeWidgetItem *item = node.parent == -1 ? new QTreeWidgetItem() : new QTreeWidgetItem(items.at(node.parent));
+        item->setText(0, node.label);
+        item->setData(0, Qt::UserRole, node.row);
+        items[i] = item;
+        if(node.parent == -1)
+        {
+            topLevelItems << item;
+        }
+    }
+    treeWidget->addTopLevelItems(topLevelItems);
+    if(topLevelItems.count() == 1)
+    {
+        topLevelItems.first()->setExpanded(true);
+    }
+}
+
+void OutlinePanel::activate(QTreeWidgetItem *item)
+{
+    if(!webView.isNull())
+    {
+        webView->gotoLine(item->data(0, Qt::UserRole).toInt() + 1);
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef OUTLINEPANEL_H
+#define OUTLINEPANEL_H
+
+
+#include <QtWidgets>
+
+class RightTabWidget;
+class WebView;
+
+class OutlinePanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    OutlinePanel(QWidget *parent, RightTabWidget *rightTabWidget);
+
+protected:
+    void showEvent(QShowEvent *showEvent);
+
+private slots:
+    void currentChanged(int index);
+    void refresh();
+    void activate(QTreeWidgetItem *item);
+
+private:
+    RightTabWidget *rightTabWidget;
+    QPointer<WebView> webView;
+    QTreeWidget *treeWidget;
+    QLabel *statusLabel;
+};
+
+
+#endif // OUTLINEPANEL_H
@@ -0,0 +1,190 @@
+#include "outputview.h"
+
+const int OutputView::Capacity;
+const int OutputView::MaxLineLength;
+const int OutputView::MaxPartialLength;
+
+OutputView::OutputView(QWidget *parent) : QAbstractScrollArea(parent)
+{
+    this->lines.resize(Capacity);
+    this->first = 0;
+    this->count = 0;
+    this->dropped = 0;
+    this->locationRegExp = QRegExp("([^\\s:'\"()<>]+\\.\\w+):(\\d+)");
+    QFont font("Ubuntu Mono");
+    font.setStyleHint(QFont::TypeWriter);
+    this->setFont(font);
+    this->viewport()->setMouseTracking(true);
+    this->viewport()->setAutoFillBackground(false);
+    this->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
+
+    //output can arrive faster than the screen refreshes, repaints are coalesced per frame
+    refreshTimer = new QTimer(this);
+    refreshTimer->setSingleShot(true);
+    refreshTimer->setInterval(16);
+    connect(refreshTimer, SIGNAL(timeout()), this, SLOT(refresh()));
+}
+
+void OutputView::append(const QByteArray &data)
+{
+    const char *begin = data.constData();
+    const char *end = begin + data.size();
+    while(begin < end)
+    {
+        const char *newline = (const char*)memchr(begin, '\n', end - begin);
+        if(newline == 0)
+        {
+            partial.append(begin, end - begin);
+            if(partial.size() > MaxPartialLength)
+            {
+                //output that never ends a line (progress bars, binary) is shown in pieces instead of piling up
+                appendLine(partial.constData(), partial.size());
+                partial.clear();
+            }
+            break;
+        }
+        if(partial.isEmpty())
+        {
+            appendLine(begin, newline - begin);
+        }
+        else
+        {
+            partial.append(begin, newline - begin);
+            appendLine(partial.constData(), partial.size());
+            partial.clear();
+        }
+        begin = newline + 1;
+    }
+    if(!refreshTimer->isActive())
+    {
+        refreshTimer->start();
+    }
+}
+
+void OutputView::flush()
+{
+    if(!partial.isEmpty())
+    {
+        appendLine(partial.constData(), partial.size());
+        partial.clear();
+    }
+    refresh();
+}
+
+void OutputView::appendLine(const char *data, int length)
+{
+    if(length > 0 && data[length - 1] == '\r')
+    {
+        length--;
+    }
+    QString text = QString::fromUtf8(data, qMin(length, MaxLineLength));
+    if(count < Capacity)
+    {
+        lines[(first + count) % Capacity] = text;
+        count++;
+    }
+    else
+    {
+        lines[first] = text;
+        first = (first + 1) % Capacity;
+        dropped++;
+    }
+}
+
+const QString &OutputView::line(int row) const
+{
+    return lines.at((first + row) % Capacity);
+}
+
+void OutputView::clear()
+{
+    lines.fill(QString());
+    first = 0;
+    count = 0;
+    dropped = 0;
+    partial.clear();
+    refresh();
+}
+
+void OutputView::refresh()
+{
+    QScrollBar *scrollBar = this->verticalScrollBar();
+    bool followTail = scrollBar->value() == scrollBar->maximum();
+    int value = scrollBar->value() - dropped;
+    dropped = 0;
+    int lineHeight = this->fontMetrics().lineSpacing();
+    int pageRows = qMax(1, this->viewport()->height() / lineHeight);
+    scrollBar->setRange(0, qMax(0, count - pageRows));
+    scrollBar->setPageStep(pageRows);
+    scrollBar->setValue(followTail ? scrollBar->maximum() : value);
+    this->viewport()->update();
+}
+
+void OutputView::resizeEvent(QResizeEvent *resizeEvent)
+{
+    QAbstractScrollArea::resizeEvent(resizeEvent);
+    refresh();
+}
+
+void OutputView::paintEvent(QPaintEvent *paintEvent)
+{
+    QPainter painter(this->viewport());
+    painter.fillRect(paintEvent->rect(), QColor(0x27, 0x28, 0x22));
+    painter.setPen(QColor(0xf8, 0xf8, 0xf2));
+    QFontMetrics fontMetrics = this->fontMetrics();
+    int lineHeight = fontMetrics.lineSpacing();
+    int firstRow = this->verticalScrollBar()->value() + paintEvent->rect().top() / lineHeight;
+    int lastRow = qMin(count - 1, this->verticalScrollBar()->value() + paintEvent->rect().bottom() / lineHeight);
+    for(int row = firstRow; row <= lastRow; row++)
+    {
+        int y = (row - this->verticalScrollBar()->value()) * lineHeight;
+        const QString &text = line(row);
+        painter.drawText(4, y + fontMetrics.ascent(), text);
+        int index = locationRegExp.indexIn(text);
+        if(index != -1)
+        {
+            int x = 4 + fontMetrics.width(text.left(index));
+            painter.drawLine(x, y + fontMetrics.ascent() + 1, x + fontMetrics.width(locationRegExp.cap(0)), y + fontMetrics.ascent() + 1);
+        }
+    }
+}
+
+bool OutputView::locationAt(const QPoint &point, QString &path, int &lineNumber)
+{
+    int row = this->verticalScrollBar()->value() + point.y() / this->fontMetrics().lineSpacing();
+    if(row < 0 || row >= count)
+    {
+        return false;
+    }
+    const QString &text = line(row);
+    int index = locationRegExp.indexIn(text);
+    if(index == -1)
+    {
+        return false;
+    }
+    int x = 4 + this->fontMetrics().width(text.left(index));
+    if(point.x() < x || point.x() > x + this->fontMetrics().width(locationRegExp.cap(0)))
+    {
+        return false;
+    }
+    path = locationRegExp.cap(1);
+    lineNumber = locationRegExp.cap(2).toInt();
+    return true;
+}
+
+void OutputView::mouseMoveEvent(QMouseEvent *mouseEvent)
+{
+    QString path;
+    int lineNumber;
+    this->viewport()->setCursor(locationAt(mouseEvent->pos(), path, lineNumber) ? Qt::PointingHandCursor : Qt::ArrowCursor);
+}
+
+void OutputView::mousePressEvent(QMouseEvent *mouseEvent)
+{
+    QString path;
+    int lineNumber;
+    if(mouseEvent->button() == Qt::LeftButton && locationAt(mouseEvent->pos(), path, lineNumber))
+    {
+        emit locationActivated(path, lineNumber);
+    }
+}
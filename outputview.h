@@ -0,0 +1,47 @@
+#ifndef OUTPUTVIEW_H
+#define OUTPUTVIEW_H
+
+
+#include <QtWidgets>
+
+//read-only line view over a fixed-capacity ring buffer, only visible lines are painted
+class OutputView : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+signals:
+    void locationActivated(QString path, int line);
+
+public:
+    OutputView(QWidget *parent);
+    void append(const QByteArray &data);
+    void flush();
+    void clear();
+    static const int Capacity = 100000;
+    static const int MaxLineLength = 1000;
+    static const int MaxPartialLength = 64 * 1024;
+
+protected:
+    void paintEvent(QPaintEvent *paintEvent);
+    void resizeEvent(QResizeEvent *resizeEvent);
+    void mousePressEvent(QMouseEvent *mouseEvent);
+    void mouseMoveEvent(QMouseEvent *mouseEvent);
+
+private slots:
+    void refresh();
+
+private:
+    void appendLine(const char *data, int length);
+    const QString &line(int row) const;
+    bool locationAt(const QPoint &point, QString &path, int &lineNumber);
+    QVector<QString> lines;
+    int first;
+    int count;
+    int dropped;
+    QByteArray partial;
+    QTimer *refreshTimer;
+    QRegExp locationRegExp;
+};
+
+
+#endif // OUTPUTVIEW_H
@@ -0,0 +1,75 @@
+#include "projectfiles.h"
+
+const qint64 ProjectFiles::MaxFileSize;
+
+ProjectWalker::ProjectWalker(const QString &folderPath)
+{
+    pendingDirs << QDir(folderPath).absolutePath();
+    GitIgnore::instance()->addProjectFolder(folderPath);
+    position = 0;
+}
+
+bool ProjectWalker::hasNext()
+{
+    while(true)
+    {
+        while(position < entries.count())
+        {
+            const QFileInfo &fileInfo = entries.at(position++);
+            QString path = fileInfo.absoluteFilePath();
+            bool isDir = fileInfo.isDir();
+            if(GitIgnore::isIgnored(chain, path, fileInfo.fileName(), isDir))
+            {
+                continue;
+            }
+            if(isDir)
+            {
+                pendingDirs << path;
+                continue;
+            }
+            current = fileInfo;
+            return true;
+        }
+        if(pendingDirs.isEmpty())
+        {
+            return false;
+        }
+        QString dirPath = pendingDirs.takeLast();
+        QDir dir(dirPath);
+        entries = dir.entryInfoList(QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot | QDir::NoSymLinks, QDir::Name | QDir::DirsLast);
+        chain = GitIgnore::instance()->chain(dirPath);
+        position = 0;
+    }
+}
+
+QString ProjectWalker::next()
+{
+    return current.absoluteFilePath();
+}
+
+QFileInfo ProjectWalker::fileInfo() const
+{
+    return current;
+}
+
+QStringList ProjectFiles::list(const QString &folderPath)
+{
+    QStringList filePaths;
+    ProjectWalker walker(folderPath);
+    while(walker.hasNext())
+    {
+        QString filePath = walker.next();
+        if(walker.fileInfo().size() > MaxFileSize)
+        {
+            continue;
+        }
+        filePaths << filePath;
+    }
+    return filePaths;
+}
+
+bool ProjectFiles::isText(const QByteArray &content)
+{
+    //same rule as git: a NUL byte near the start means binary
+    return !content.left(8000).contains('\0');
+}
@@ -0,0 +1,36 @@
+#ifndef PROJECTFILES_H
+#define PROJECTFILES_H
+
+
+#include <QtCore>
+
+#include "gitignore.h"
+
+//walks the files of a folder, ignored folders are skipped before they are entered
+class ProjectWalker
+{
+public:
+    ProjectWalker(const QString &folderPath);
+    bool hasNext();
+    QString next();
+    QFileInfo fileInfo() const;
+
+private:
+    QStringList pendingDirs;
+    QFileInfoList entries;
+    IgnoreChain chain;
+    int position;
+    QFileInfo current;
+};
+
+//enumerates the files of an opened folder for the background indexers
+class ProjectFiles
+{
+public:
+    static QStringList list(const QString &folderPath);
+    static bool isText(const QByteArray &content);
+    static const qint64 MaxFileSize = 4 * 1024 * 1024;
+};
+
+
+#endif // PROJECTFILES_H
@@ -0,0 +1,80 @@
+#include "projectmodel.h"
+#include "gitignore.h"
+
+ProjectModel::ProjectModel(QObject *parent) : QFileSystemModel(parent)
+{
+    mShowIgnored = false;
+    fileSystemWatcher = new QFileSystemWatcher(this);
+    connect(fileSystemWatcher, SIGNAL(fileChanged(QString)), this, SLOT(ignoreFileChanged(QString)));
+    connect(this, SIGNAL(directoryLoaded(QString)), this, SLOT(watchIgnoreFile(QString)));
+}
+
+bool ProjectModel::isIgnored(const QModelIndex &index) const
+{
+    return GitIgnore::instance()->isIgnored(this->filePath(index), this->isDir(index));
+}
+
+QVariant ProjectModel::data(const QModelIndex &index, int role) const
+{
+    if(role == Qt::ForegroundRole && index.isValid() && isIgnored(index))
+    {
+        return QColor(Qt::gray);
+    }
+    return QFileSystemModel::data(index, role);
+}
+
+bool ProjectModel::hasChildren(const QModelIndex &parent) const
+{
+    if(!mShowIgnored && parent.isValid() && this->isDir(parent) && isIgnored(parent))
+    {
+        return false;
+    }
+    return QFileSystemModel::hasChildren(parent);
+}
+
+bool ProjectModel::canFetchMore(const QModelIndex &parent) const
+{
+    if(!mShowIgnored && parent.isValid() && this->isDir(parent) && isIgnored(parent))
+    {
+        return false;
+    }
+    return QFileSystemModel::canFetchMore(parent);
+}
+
+bool ProjectModel::showIgnored() const
+{
+    return mShowIgnored;
+}
+
+void ProjectModel::setShowIgnored(bool showIgnored)
+{
+    mShowIgnored = showIgnored;
+    refresh();
+}
+
+void ProjectModel::watchIgnoreFile(const QString &dirPath)
+{
+    QString filePath = dirPath + "/.gitignore";
+    if(QFileInfo(filePath).exists() && !fileSystemWatcher->files().contains(filePath))
+    {
+        fileSystemWatcher->addPath(filePath);
+    }
+}
+
+void ProjectModel::ignoreFileChanged(const QString &filePath)
+{
+    GitIgnore::instance()->invalidate(filePath);
+    //editors replace the file on save, which drops it from the watcher
+    if(QFileInfo(filePath).exists() && !fileSystemWatcher->files().contains(filePath))
+    {
+        fileSystemWatcher->addPath(filePath);
+    }
+    refresh();
+}
+
+void ProjectModel::refresh()
+{
+    //expansion arrows and colors of already listed rows depend on the rules
+    emit layoutAboutToBeChanged();
+    emit layoutChanged();
+}
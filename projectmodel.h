@@ -0,0 +1,33 @@
+#ifndef PROJECTMODEL_H
+#define PROJECTMODEL_H
+
+
+#include <QtWidgets>
+
+//file system model of an opened folder; ignored entries are dimmed and, unless
+//showIgnored is set, ignored folders are not expanded so they are never listed
+class ProjectModel : public QFileSystemModel
+{
+    Q_OBJECT
+
+public:
+    ProjectModel(QObject *parent);
+    QVariant data(const QModelIndex &index, int role) const;
+    bool hasChildren(const QModelIndex &parent) const;
+    bool canFetchMore(const QModelIndex &parent) const;
+    bool isIgnored(const QModelIndex &index) const;
+    bool showIgnored() const;
+    void setShowIgnored(bool showIgnored);
+
+private slots:
+    void watchIgnoreFile(const QString &dirPath);
+    void ignoreFileChanged(const QString &filePath);
+
+private:
+    void refresh();
+    QFileSystemWatcher *fileSystemWatcher;
+    bool mShowIgnored;
+};
+
+
+#endif // PROJECTMODEL_H
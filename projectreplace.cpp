@@ -0,0 +1,431 @@
+#include "projectreplace.h"
+#include "projectfiles.h"
+#include "righttabwidget.h"
+#include "webview.h"
+#include "textbuffer.h"
+#include "linediff.h"
+
+ReplaceQuery::ReplaceQuery()
+{
+    this->regularExpression = false;
+    this->caseSensitivity = Qt::CaseSensitive;
+}
+
+ReplaceQuery::ReplaceQuery(QString find, QString replacement, bool regularExpression, bool caseSensitive)
+{
+    this->text = find;
+    this->replacement = replacement;
+    this->regularExpression = regularExpression;
+    this->caseSensitivity = caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
+    if(regularExpression)
+    {
+        this->regExp = QRegularExpression(find, caseSensitive ? QRegularExpression::NoPatternOption : QRegularExpression::CaseInsensitiveOption);
+    }
+}
+
+bool ReplaceQuery::isValid() const
+{
+    return !text.isEmpty() && (!regularExpression || regExp.isValid());
+}
+
+//non-empty regular expression matches, zero-length ones are neither listed nor replaced
+QList<QRegularExpressionMatch> ReplaceQuery::matches(const QString &line) const
+{
+    QList<QRegularExpressionMatch> matches;
+    QRegularExpressionMatchIterator i = regExp.globalMatch(line);
+    while(i.hasNext())
+    {
+        QRegularExpressionMatch match = i.next();
+        if(match.capturedLength() > 0)
+        {
+            matches << match;
+        }
+    }
+    return matches;
+}
+
+//replacement with \1 ... \99 substituted, the same back references QString::replace understands
+QString ReplaceQuery::expand(const QRegularExpressionMatch &match) const
+{
+    QString result;
+    int length = replacement.length();
+    for(int i = 0; i < length; i++)
+    {
+        if(replacement.at(i) == QLatin1Char('\\') && i + 1 < length && replacement.at(i + 1).isDigit())
+        {
+            int group = replacement.at(i + 1).digitValue();
+            int end = i + 2;
+            if(end < length && replacement.at(end).isDigit() && group * 10 + replacement.at(end).digitValue() <= regExp.captureCount())
+            {
+                group = group * 10 + replacement.at(end).digitValue();
+                end++;
+            }
+            if(group <= regExp.captureCount())
+            {
+                result += match.captured(group);
+                i = end - 1;
+                continue;
+            }
+        }
+        result += replacement.at(i);
+    }
+    return result;
+}
+
+QList<ReplaceMatch> ReplaceQuery::find(const QString &line, int lineNumber) const
+{
+    QList<ReplaceMatch> matches;
+    ReplaceMatch match;
+    match.line = lineNumber;
+    match.preview = line.trimmed().left(200);
+    if(regularExpression)
+    {
+        foreach(const QRegularExpressionMatch &regExpMatch, this->matches(line))
+        {
+            match.column = regExpMatch.capturedStart();
+            match.length = regExpMatch.capturedLength();
+            matches << match;
+        }
+        return matches;
+    }
+    int index = 0;
+    while((index = line.indexOf(text, index, caseSensitivity)) != -1)
+    {
+        match.column = index;
+        match.length = text.length();
+        matches << match;
+        index += text.length();
+    }
+    return matches;
+}
+
+//replaces exactly the matches find() reports
+QString ReplaceQuery::replace(const QString &line) const
+{
+    QString result;
+    int position = 0;
+    if(regularExpression)
+    {
+        foreach(const QRegularExpressionMatch &match, matches(line))
+        {
+            result += line.midRef(position, match.capturedStart() - position);
+            result += expand(match);
+            position = match.capturedEnd();
+        }
+    }
+    else
+    {
+        foreach(const ReplaceMatch &match, find(line, 0))
+        {
+            result += line.midRef(position, match.column - position);
+            result += replacement;
+            position = match.column + match.length;
+        }
+    }
+    result += line.midRef(position);
+    return result;
+}
+
+ProjectSearch::ProjectSearch(QObject *parent) : QObject(parent)
+{
+    this->id = 0;
+    qRegisterMetaType<ReplaceFile>("ReplaceFile");
+}
+
+ProjectSearch::~ProjectSearch()
+{
+    cancel();
+    pool.waitForDone();
+}
+
+int ProjectSearch::start(QString folderPath, ReplaceQuery query, QHash<QString, QStringList> openBuffers)
+{
+    cancel();
+    pool.waitForDone();
+    this->id++;
+    this->folderPath = folderPath;
+    this->query = query;
+    this->openBuffers = openBuffers;
+    this->filePaths = ProjectFiles::list(folderPath);
+    this->next.storeRelease(0);
+    this->canceled.storeRelease(0);
+    int workers = qMax(1, QThread::idealThreadCount());
+    this->remaining.storeRelease(workers);
+    for(int i = 0; i < workers; i++)
+    {
+        pool.start(new ProjectSearchWorker(this));
+    }
+    return id;
+}
+
+void ProjectSearch::cancel()
+{
+    canceled.storeRelease(1);
+}
+
+void ProjectSearch::finish(int id)
+{
+    emit finished(id);
+}
+
+void ProjectSearch::search()
+{
+    int index;
+    while(!canceled.loadAcquire() && (index = next.fetchAndAddOrdered(1)) < filePaths.count())
+    {
+        const QString &filePath = filePaths.at(index);
+        QFileInfo fileInfo(filePath);
+        ReplaceFile file;
+        file.filePath = filePath;
+        file.size = fileInfo.size();
+        file.modified = fileInfo.lastModified().toMSecsSinceEpoch();
+        file.open = openBuffers.contains(filePath);
+        QStringList lines;
+        if(file.open)
+        {
+            lines = openBuffers.value(filePath);
+        }
+        else
+        {
+            QFile input(filePath);
+            if(!input.open(QIODevice::ReadOnly))
+            {
+                continue;
+            }
+            QByteArray content = input.readAll();
+            input.close();
+            if(!ProjectFiles::isText(content))
+            {
+                continue;
+            }
+            lines = TextBuffer::splitLines(QString::fromUtf8(content));
+        }
+        for(int i = 0; i < lines.count(); i++)
+        {
+            file.matches += query.find(lines.at(i), i);
+        }
+        if(!file.matches.isEmpty())
+        {
+            emit found(id, file);
+        }
+    }
+    if(remaining.fetchAndAddOrdered(-1) == 1)
+    {
+        QMetaObject::invokeMethod(this, "finish", Qt::QueuedConnection, Q_ARG(int, id));
+    }
+}
+
+ProjectSearchWorker::ProjectSearchWorker(ProjectSearch *projectSearch)
+{
+    this->projectSearch = projectSearch;
+}
+
+void ProjectSearchWorker::run()
+{
+    projectSearch->search();
+}
+
+ReplaceTransaction::ReplaceTransaction(QObject *parent, RightTabWidget *rightTabWidget, ReplaceQuery query) : QObject(parent)
+{
+    this->rightTabWidget = rightTabWidget;
+    this->query = query;
+    this->restoring = false;
+    this->rollingBack = false;
+    this->applied = false;
+}
+
+ReplaceTransaction::~ReplaceTransaction()
+{
+    pool.waitForDone();
+}
+
+bool ReplaceTransaction::isApplied() const
+{
+    return applied;
+}
+
+void ReplaceTransaction::apply(QList<ReplaceFile> files)
+{
+    foreach(const ReplaceFile &file, files)
+    {
+        if(rightTabWidget->webView(file.filePath) != 0)
+        {
+            openFiles << file;
+        }
+        else
+        {
+            diskFiles << file;
+        }
+    }
+    rewritten.fill(false, diskFiles.count());
+    run(false);
+}
+
+void ReplaceTransaction::revert()
+{
+    if(!applied)
+    {
+        return;
+    }
+    applied = false;
+    foreach(const QString &filePath, originalBuffers.keys())
+    {
+        WebView *webView = rightTabWidget->webView(filePath);
+        if(webView == 0)
+        {
+            continue;
+        }
+        QStringList currentLines = webView->buffer()->lines();
+        QStringList originalLines = originalBuffers.value(filePath);
+        webView->applyEdits(LineDiff::edits(currentLines, originalLines, LineDiff::diff(currentLines, originalLines)));
+    }
+    originalBuffers.clear();
+    run(true);
+}
+
+void ReplaceTransaction::run(bool restoring)
+{
+    this->restoring = restoring;
+    errors.clear();
+    next.storeRelease(0);
+    int workers = qBound(1, diskFiles.count(), QThread::idealThreadCount());
+    remaining.storeRelease(workers);
+    for(int i = 0; i < workers; i++)
+    {
+        pool.start(new ReplaceWorker(this));
+    }
+}
+
+void ReplaceTransaction::rewrite(int index)
+{
+    const ReplaceFile &file = diskFiles.at(index);
+    QFileInfo fileInfo(file.filePath);
+    if(fileInfo.size() != file.size || fileInfo.lastModified().toMSecsSinceEpoch() != file.modified)
+    {
+        QMutexLocker locker(&mutex);
+        errors << QObject::tr("%1 changed since it was searched").arg(file.filePath);
+        return;
+    }
+    QString backupPath = backupDir.path() + "/" + QString::number(index);
+    QFile input(file.filePath);
+    QSaveFile output(file.filePath);
+    if(!backupDir.isValid() || !QFile::copy(file.filePath, backupPath) || !input.open(QIODevice::ReadOnly) || !output.open(QIODevice::WriteOnly))
+    {
+        QMutexLocker locker(&mutex);
+        errors << QObject::tr("Cannot rewrite %1").arg(file.filePath);
+        return;
+    }
+
+    //split with the search's line rules so both agree on the lines, the terminators are copied untouched
+    QStringList terminators;
+    QStringList lines = TextBuffer::splitLines(QString::fromUtf8(input.readAll()), &terminators);
+    input.close();
+    for(int i = 0; i < lines.count(); i++)
+    {
+        output.write(query.replace(lines.at(i)).toUtf8());
+        output.write(terminators.at(i).toLatin1());
+    }
+    if(!output.commit())
+    {
+        QMutexLocker locker(&mutex);
+        errors << QObject::tr("Cannot write %1").arg(file.filePath);
+        return;
+    }
+    rewritten[index] = true;
+}
+
+void ReplaceTransaction::restore(int index)
+{
+    if(!rewritten.at(index))
+    {
+        return;
+    }
+    const ReplaceFile &file = diskFiles.at(index);
+    QFile backup(backupDir.path() + "/" + QString::number(index));
+    QSaveFile output(file.filePath);
+    if(!backup.open(QIODevice::ReadOnly) || !output.open(QIODevice::WriteOnly))
+    {
+        QMutexLocker locker(&mutex);
+        errors << QObject::tr("Cannot restore %1").arg(file.filePath);
+        return;
+    }
+    while(!backup.atEnd())
+    {
+        output.write(backup.read(64 * 1024));
+    }
+    if(!output.commit())
+    {
+        QMutexLocker locker(&mutex);
+        errors << QObject::tr("Cannot restore %1").arg(file.filePath);
+        return;
+    }
+    rewritten[index] = false;
+}
+
+void ReplaceTransaction::finishRewrite()
+{
+    if(restoring && rollingBack)
+    {
+        rollingBack = false;
+        emit finished(failures + errors);
+        return;
+    }
+    if(restoring)
+    {
+        emit reverted(errors);
+        return;
+    }
+    if(!errors.isEmpty())
+    {
+        //all or nothing: put back the files that were already rewritten
+        failures = errors;
+        rollingBack = true;
+        run(true);
+        return;
+    }
+
+    //open files get the replacement as edits, never rewritten behind the editor's back
+    foreach(const ReplaceFile &file, openFiles)
+    {
+        WebView *webView = rightTabWidget->webView(file.filePath);
+        if(webView == 0)
+        {
+            continue;
+        }
+        QStringList originalLines = webView->buffer()->lines();
+        QStringList lines;
+        foreach(const QString &line, originalLines)
+        {
+            lines << query.replace(line);
+        }
+        webView->applyEdits(LineDiff::edits(originalLines, lines, LineDiff::diff(originalLines, lines)));
+        originalBuffers.insert(file.filePath, originalLines);
+    }
+    applied = true;
+    emit finished(errors);
+}
+
+ReplaceWorker::ReplaceWorker(ReplaceTransaction *transaction)
+{
+    this->transaction = transaction;
+}
+
+void ReplaceWorker::run()
+{
+    int index;
+    while((index = transaction->next.fetchAndAddOrdered(1)) < transaction->diskFiles.count())
+    {
+        if(transaction->restoring)
+        {
+            transaction->restore(index);
+        }
+        else
+        {
+            transaction->rewrite(index);
+        }
+    }
+    if(transaction->remaining.fetchAndAddOrdered(-1) == 1)
+    {
+        QMetaObject::invokeMethod(transaction, "finishRewrite", Qt::QueuedConnection);
+    }
+}
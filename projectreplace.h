@@ -0,0 +1,145 @@
+#ifndef PROJECTREPLACE_H
+#define PROJECTREPLACE_H
+
+
+#include <QtCore>
+
+class RightTabWidget;
+
+struct ReplaceMatch
+{
+    int line;
+    int column;
+    int length;
+    QString preview;
+};
+
+//matches of one file, with the stat data the rewrite checks before touching it
+struct ReplaceFile
+{
+    QString filePath;
+    qint64 size;
+    qint64 modified;
+    bool open;
+    QList<ReplaceMatch> matches;
+};
+
+Q_DECLARE_METATYPE(ReplaceFile)
+
+class ReplaceQuery
+{
+public:
+    ReplaceQuery();
+    ReplaceQuery(QString find, QString replacement, bool regularExpression, bool caseSensitive);
+    bool isValid() const;
+    QList<ReplaceMatch> find(const QString &line, int lineNumber) const;
+    QString replace(const QString &line) const;
+
+private:
+    QList<QRegularExpressionMatch> matches(const QString &line) const;
+    QString expand(const QRegularExpressionMatch &match) const;
+    QString text;
+    QString replacement;
+    bool regularExpression;
+    Qt::CaseSensitivity caseSensitivity;
+    QRegularExpression regExp;
+};
+
+//finds matches in parallel, open buffers are searched instead of their files
+class ProjectSearch : public QObject
+{
+    Q_OBJECT
+
+signals:
+    //id is the one start() returned, signals still queued from an earlier search carry its id
+    void found(int id, ReplaceFile file);
+    void finished(int id);
+
+public:
+    ProjectSearch(QObject *parent);
+    ~ProjectSearch();
+    int start(QString folderPath, ReplaceQuery query, QHash<QString, QStringList> openBuffers);
+    void cancel();
+
+private slots:
+    void finish(int id);
+
+private:
+    void search();
+    QString folderPath;
+    ReplaceQuery query;
+    QHash<QString, QStringList> openBuffers;
+    QStringList filePaths;
+    int id;
+    QAtomicInt next;
+    QAtomicInt remaining;
+    QAtomicInt canceled;
+    QThreadPool pool;
+    friend class ProjectSearchWorker;
+};
+
+class ProjectSearchWorker : public QRunnable
+{
+public:
+    ProjectSearchWorker(ProjectSearch *projectSearch);
+    void run();
+
+private:
+    ProjectSearch *projectSearch;
+};
+
+//rewrites unopened files (stream, temp file, atomic rename) on worker threads and edits open ones in place;
+//keeps backups so the whole batch can be reverted
+class ReplaceTransaction : public QObject
+{
+    Q_OBJECT
+
+signals:
+    void finished(QStringList errors);
+    void reverted(QStringList errors);
+
+public:
+    ReplaceTransaction(QObject *parent, RightTabWidget *rightTabWidget, ReplaceQuery query);
+    ~ReplaceTransaction();
+    void apply(QList<ReplaceFile> files);
+    void revert();
+    bool isApplied() const;
+
+private slots:
+    void finishRewrite();
+
+private:
+    void rewrite(int index);
+    void restore(int index);
+    void run(bool restoring);
+    RightTabWidget *rightTabWidget;
+    ReplaceQuery query;
+    QList<ReplaceFile> diskFiles;
+    QList<ReplaceFile> openFiles;
+    QHash<QString, QStringList> originalBuffers;
+    QVector<bool> rewritten;
+    QStringList errors;
+    QStringList failures;
+    QMutex mutex;
+    QTemporaryDir backupDir;
+    QAtomicInt next;
+    QAtomicInt remaining;
+    bool restoring;
+    bool rollingBack;
+    bool applied;
+    QThreadPool pool;
+    friend class ReplaceWorker;
+};
+
+class ReplaceWorker : public QRunnable
+{
+public:
+    ReplaceWorker(ReplaceTransaction *transaction);
+    void run();
+
+private:
+    ReplaceTransaction *transaction;
+};
+
+
+#endif // PROJECTREPLACE_H
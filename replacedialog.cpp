@@ -0,0 +1,207 @@
+#include "replacedialog.h"
+#include "righttabwidget.h"
+#include "mainwindow.h"
+
+ReplaceDialog::ReplaceDialog(QString folderPath, RightTabWidget *rightTabWidget)
+{
+    this->folderPath = folderPath;
+    this->rightTabWidget = rightTabWidget;
+    this->transaction = 0;
+    this->searchId = 0;
+    this->queryEdited = false;
+    this->matchCount = 0;
+    this->replacedCount = 0;
+    this->setWindowTitle(tr("Replace in %1").arg(folderPath));
+    this->resize(720, 480);
+
+    findLineEdit = new QLineEdit();
+    replaceLineEdit = new QLineEdit();
+    regularExpressionCheckBox = new QCheckBox(tr("Regular e&xpression"));
+    caseSensitiveCheckBox = new QCheckBox(tr("&Case sensitive"));
+    caseSensitiveCheckBox->setChecked(true);
+    QPushButton *findButton = new QPushButton(tr("&Find"));
+    replaceButton = new QPushButton(tr("&Replace All"));
+    replaceButton->setEnabled(false);
+    revertButton = new QPushButton(tr("Re&vert"));
+    revertButton->setEnabled(false);
+    treeWidget = new QTreeWidget();
+    treeWidget->setHeaderHidden(true);
+    statusLabel = new QLabel();
+
+    QFormLayout *formLayout = new QFormLayout();
+    formLayout->addRow(tr("Find:"), findLineEdit);
+    formLayout->addRow(tr("Replace with:"), replaceLineEdit);
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    buttonLayout->addWidget(regularExpressionCheckBox);
+    buttonLayout->addWidget(caseSensitiveCheckBox);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(findButton);
+    buttonLayout->addWidget(replaceButton);
+    buttonLayout->addWidget(revertButton);
+    QVBoxLayout *layout = new QVBoxLayout();
+    layout->addLayout(formLayout);
+    layout->addLayout(buttonLayout);
+    layout->addWidget(treeWidget);
+    layout->addWidget(statusLabel);
+    this->setLayout(layout);
+
+    projectSearch = new ProjectSearch(this);
+    connect(projectSearch, SIGNAL(found(int, ReplaceFile)), this, SLOT(addFile(int, ReplaceFile)));
+    connect(projectSearch, SIGNAL(finished(int)), this, SLOT(searchFinished(int)));
+    connect(findLineEdit, SIGNAL(returnPressed()), this, SLOT(find()));
+    connect(findButton, SIGNAL(clicked()), this, SLOT(find()));
+    connect(findLineEdit, SIGNAL(textChanged(QString)), this, SLOT(queryChanged()));
+    connect(replaceLineEdit, SIGNAL(textChanged(QString)), this, SLOT(queryChanged()));
+    connect(regularExpressionCheckBox, SIGNAL(toggled(bool)), this, SLOT(queryChanged()));
+    connect(caseSensitiveCheckBox, SIGNAL(toggled(bool)), this, SLOT(queryChanged()));
+    connect(replaceButton, SIGNAL(clicked()), this, SLOT(replace()));
+    connect(revertButton, SIGNAL(clicked()), this, SLOT(revert()));
+    connect(treeWidget, SIGNAL(itemActivated(QTreeWidgetItem*, int)), this, SLOT(openMatch(QTreeWidgetItem*)));
+}
+
+ReplaceQuery ReplaceDialog::query()
+{
+    return ReplaceQuery(findLineEdit->text(), replaceLineEdit->text(), regularExpressionCheckBox->isChecked(), caseSensitiveCheckBox->isChecked());
+}
+
+void ReplaceDialog::find()
+{
+    if(!query().isValid())
+    {
+        statusLabel->setText(tr("Invalid search"));
+        return;
+    }
+    treeWidget->clear();
+    files.clear();
+    searchQuery = query();
+    queryEdited = false;
+    matchCount = 0;
+    replaceButton->setEnabled(false);
+    statusLabel->setText(tr("Searching..."));
+    searchId = projectSearch->start(folderPath, searchQuery, rightTabWidget->openBuffers());
+}
+
+//the listed matches no longer show what a replace would change
+void ReplaceDialog::queryChanged()
+{
+    queryEdited = true;
+    if(replaceButton->isEnabled())
+    {
+        replaceButton->setEnabled(false);
+        statusLabel->setText(tr("Search again to replace"));
+    }
+}
+
+void ReplaceDialog::addFile(int id, ReplaceFile file)
+{
+    if(id != searchId)
+    {
+        return; //queued before the search was restarted
+    }
+    QTreeWidgetItem *fileItem = new QTreeWidgetItem(treeWidget);
+    fileItem->setText(0, QString("%1 (%2)").arg(file.filePath.mid(folderPath.length() + 1)).arg(file.matches.count()));
+    fileItem->setCheckState(0, Qt::Checked);
+    fileItem->setData(0, Qt::UserRole, files.count());
+    foreach(const ReplaceMatch &match, file.matches.mid(0, 100))
+    {
+        QTreeWidgetItem *matchItem = new QTreeWidgetItem(fileItem);
+        matchItem->setText(0, QString("%1: %2").arg(match.line + 1).arg(match.preview));
+        matchItem->setData(0, Qt::UserRole, match.line + 1);
+    }
+    files << file;
+    matchCount += file.matches.count();
+}
+
+void ReplaceDialog::searchFinished(int id)
+{
+    if(id != searchId)
+    {
+        return;
+    }
+    treeWidget->sortItems(0, Qt::AscendingOrder);
+    if(queryEdited)
+    {
+        statusLabel->setText(tr("%1 matches in %2 files, search again to replace").arg(matchCount).arg(files.count()));
+        return;
+    }
+    statusLabel->setText(tr("%1 matches in %2 files").arg(matchCount).arg(files.count()));
+    replaceButton->setEnabled(!files.isEmpty());
+}
+
+void ReplaceDialog::replace()
+{
+    QList<ReplaceFile> checkedFiles;
+    replacedCount = 0;
+    for(int i = 0; i < treeWidget->topLevelItemCount(); i++)
+    {
+        QTreeWidgetItem *item = treeWidget->topLevelItem(i);
+        if(item->checkState(0) == Qt::Checked)
+        {
+            checkedFiles << files.at(item->data(0, Qt::UserRole).toInt());
+            replacedCount += checkedFiles.last().matches.count();
+        }
+    }
+    if(checkedFiles.isEmpty())
+    {
+        return;
+    }
+    if(transaction != 0)
+    {
+        transaction->deleteLater();
+    }
+    transaction = new ReplaceTransaction(this, rightTabWidget, searchQuery);
+    connect(transaction, SIGNAL(finished(QStringList)), this, SLOT(replaceFinished(QStringList)));
+    connect(transaction, SIGNAL(reverted(QStringList)), this, SLOT(reverted(QStringList)));
+    replaceButton->setEnabled(false);
+    revertButton->setEnabled(false);
+    statusLabel->setText(tr("Replacing..."));
+    transaction->apply(checkedFiles);
+}
+
+void ReplaceDialog::replaceFinished(QStringList errors)
+{
+    treeWidget->clear();
+    files.clear();
+    if(!errors.isEmpty())
+    {
+        statusLabel->setText(tr("Nothing was replaced: %1").arg(errors.join("; ")));
+        return;
+    }
+    statusLabel->setText(tr("Replaced %1 matches, they can be reverted until this dialog is closed").arg(replacedCount));
+    revertButton->setEnabled(transaction->isApplied());
+}
+
+void ReplaceDialog::revert()
+{
+    revertButton->setEnabled(false);
+    statusLabel->setText(tr("Reverting..."));
+    transaction->revert();
+}
+
+void ReplaceDialog::reverted(QStringList errors)
+{
+    statusLabel->setText(errors.isEmpty() ? tr("Reverted") : errors.join("; "));
+}
+
+//the backups Revert restores from are temporary and go away with the dialog
+void ReplaceDialog::reject()
+{
+    if(transaction != 0 && transaction->isApplied())
+    {
+        if(QMessageBox::question(this, tr("Replace"), tr("Closing this dialog deletes the backups, the replacement can no longer be reverted. Close anyway?")) != QMessageBox::Yes)
+        {
+            return;
+        }
+    }
+    QDialog::reject();
+}
+
+void ReplaceDialog::openMatch(QTreeWidgetItem *item)
+{
+    if(item->parent() == 0)
+    {
+        return;
+    }
+    const ReplaceFile &file = files.at(item->parent()->data(0, Qt::UserRole).toInt());
+    emit MainWindow::GetInstance()->openFileAtLineRequested(file.filePath, item->data(0, Qt::UserRole).toInt());
+}
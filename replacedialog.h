@@ -0,0 +1,52 @@
+#ifndef REPLACEDIALOG_H
+#define REPLACEDIALOG_H
+
+
+#include <QtWidgets>
+#include "projectreplace.h"
+
+class ReplaceDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    ReplaceDialog(QString folderPath, RightTabWidget *rightTabWidget);
+
+public slots:
+    void reject();
+
+private slots:
+    void find();
+    void addFile(int id, ReplaceFile file);
+    void searchFinished(int id);
+    void queryChanged();
+    void replace();
+    void replaceFinished(QStringList errors);
+    void revert();
+    void reverted(QStringList errors);
+    void openMatch(QTreeWidgetItem *item);
+
+private:
+    ReplaceQuery query();
+    QString folderPath;
+    RightTabWidget *rightTabWidget;
+    QLineEdit *findLineEdit;
+    QLineEdit *replaceLineEdit;
+    QCheckBox *regularExpressionCheckBox;
+    QCheckBox *caseSensitiveCheckBox;
+    QPushButton *replaceButton;
+    QPushButton *revertButton;
+    QTreeWidget *treeWidget;
+    QLabel *statusLabel;
+    ProjectSearch *projectSearch;
+    ReplaceTransaction *transaction;
+    QList<ReplaceFile> files;
+    int searchId;
+    ReplaceQuery searchQuery; //the query the listed matches came from
+    bool queryEdited;
+    int matchCount;
+    int replacedCount;
+};
+
+
+#endif // REPLACEDIALOG_H
@@ -0,0 +1,154 @@
+#include "resourcemonitor.h"
+#include "righttabwidget.h"
+#include "webview.h"
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+const int ResourceMonitor::Interval;
+
+ResourceMonitor::ResourceMonitor(QWidget *parent, RightTabWidget *rightTabWidget) : QWidget(parent)
+{
+    this->rightTabWidget = rightTabWidget;
+    tableWidget = new QTableWidget(0, 5);
+    tableWidget->setHorizontalHeaderLabels(QStringList() << tr("File") << tr("Editor Text") << tr("Document") << tr("Undo History") << tr("Idle"));
+    tableWidget->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    tableWidget->verticalHeader()->hide();
+    tableWidget->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    QPushButton *dumpButton = new QPushButton(tr("&Dump Snapshot..."));
+    connect(dumpButton, SIGNAL(clicked()), this, SLOT(dump()));
+    QVBoxLayout *layout = new QVBoxLayout();
+    layout->addWidget(tableWidget);
+    layout->addWidget(dumpButton, 0, Qt::AlignRight);
+    layout->setContentsMargins(0, 0, 0, 0);
+    this->setLayout(layout);
+
+    label = new QLabel();
+    timer = new QTimer(this);
+    timer->setInterval(Interval);
+    connect(timer, SIGNAL(timeout()), this, SLOT(sample()));
+    timer->start();
+}
+
+QLabel *ResourceMonitor::summaryLabel()
+{
+    return label;
+}
+
+qint64 ResourceMonitor::residentMemory()
+{
+#ifdef Q_OS_LINUX
+    QFile file("/proc/self/statm");
+    if(file.open(QIODevice::ReadOnly))
+    {
+        QList<QByteArray> fields = file.readAll().split(' ');
+        file.close();
+        if(fields.count() > 1)
+        {
+            return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+        }
+    }
+#endif
+    return -1;
+}
+
+QString ResourceMonitor::formatBytes(qint64 bytes)
+{
+    if(bytes < 0)
+    {
+        return tr("n/a");
+    }
+    if(bytes < 1024 * 1024)
+    {
+        return QString("%1 KB").arg(bytes / 1024.0, 0, 'f', 1);
+    }
+    return QString("%1 MB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 1);
+}
+
+QJsonObject ResourceMonitor::snapshot(bool detailed)
+{
+    QJsonArray tabs;
+    qint64 documentBytes = 0;
+    for(int i = 0; i < rightTabWidget->count(); i++)
+    {
+        WebView *webView = qobject_cast<WebView*>(rightTabWidget->widget(i));
+        if(webView == 0)
+        {
+            continue;
+        }
+        QJsonObject tab = QJsonObject::fromVariantMap(webView->resourceUsage(detailed));
+        tab.insert("filePath", webView->filePath());
+        documentBytes += (qint64)tab.value("documentBytes").toDouble();
+        tabs.append(tab);
+    }
+    QJsonObject process;
+    process.insert("residentBytes", (double)residentMemory());
+    process.insert("documentBytes", (double)documentBytes);
+    process.insert("tabCount", rightTabWidget->count());
+    QJsonObject snapshot;
+    snapshot.insert("timestamp", QDateTime::currentDateTime().toString(Qt::ISODate));
+    snapshot.insert("process", process);
+    snapshot.insert("tabs", tabs);
+    return snapshot;
+}
+
+void ResourceMonitor::showEvent(QShowEvent *showEvent)
+{
+    QWidget::showEvent(showEvent);
+    sample();
+}
+
+void ResourceMonitor::sample()
+{
+    //the JavaScript side is only asked while the panel is visible
+    bool detailed = this->isVisible();
+    QJsonObject snapshot = this->snapshot(detailed);
+    QJsonObject process = snapshot.value("process").toObject();
+    label->setText(tr("%1 tabs, documents %2, process %3")
+                   .arg(process.value("tabCount").toInt())
+                   .arg(formatBytes((qint64)process.value("documentBytes").toDouble()))
+                   .arg(formatBytes((qint64)process.value("residentBytes").toDouble())));
+    if(!detailed)
+    {
+        return;
+    }
+    QJsonArray tabs = snapshot.value("tabs").toArray();
+    tableWidget->setRowCount(tabs.count());
+    for(int i = 0; i < tabs.count(); i++)
+    {
+        QJsonObject tab = tabs.at(i).toObject();
+        QStringList cells;
+        cells << QFileInfo(tab.value("filePath").toString()).fileName()
+              << formatBytes((qint64)tab.value("editorBytes").toDouble())
+              << formatBytes((qint64)tab.value("documentBytes").toDouble())
+              << tr("%1 (%2)").arg(tab.value("undoEntries").toInt()).arg(formatBytes((qint64)tab.value("undoBytes").toDouble()))
+              << tr("%1 s").arg((qint64)tab.value("idleMilliseconds").toDouble() / 1000);
+        for(int j = 0; j < cells.count(); j++)
+        {
+            QTableWidgetItem *item = tableWidget->item(i, j);
+            if(item == 0)
+            {
+                item = new QTableWidgetItem();
+                tableWidget->setItem(i, j, item);
+            }
+            item->setText(cells.at(j));
+        }
+        tableWidget->item(i, 0)->setToolTip(tab.value("filePath").toString());
+    }
+}
+
+void ResourceMonitor::dump()
+{
+    QString filePath = QFileDialog::getSaveFileName(this, tr("Dump Resource Snapshot"), QDir::homePath() + "/neoeditor-resources.json", tr("JSON (*.json)"));
+    if(filePath.isEmpty())
+    {
+        return;
+    }
+    QFile file(filePath);
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        return;
+    }
+    file.write(QJsonDocument(snapshot(true)).toJson());
+    file.close();
+}
@@ -0,0 +1,37 @@
+#ifndef RESOURCEMONITOR_H
+#define RESOURCEMONITOR_H
+
+
+#include <QtWidgets>
+
+class RightTabWidget;
+
+//per-tab memory and resource panel; the status bar summary only uses native numbers so it can stay on
+class ResourceMonitor : public QWidget
+{
+    Q_OBJECT
+
+public:
+    ResourceMonitor(QWidget *parent, RightTabWidget *rightTabWidget);
+    QLabel *summaryLabel();
+    QJsonObject snapshot(bool detailed);
+    static qint64 residentMemory();
+    static QString formatBytes(qint64 bytes);
+    static const int Interval = 2000;
+
+public slots:
+    void sample();
+    void dump();
+
+protected:
+    void showEvent(QShowEvent *showEvent);
+
+private:
+    RightTabWidget *rightTabWidget;
+    QTableWidget *tableWidget;
+    QLabel *label;
+    QTimer *timer;
+};
+
+
+#endif // RESOURCEMONITOR_H
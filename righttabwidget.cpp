@@ -1,6 +1,12 @@
 #include "righttabwidget.h"
 #include "webview.h"
 #include "tabbar.h"
+#include "textbuffer.h"
+#include "csvview.h"
+#include "resourcemonitor.h"
+#if defined(Q_OS_LINUX) && defined(__GLIBC__)
+#include <malloc.h>
+#endif
 
 RightTabWidget::RightTabWidget(QWidget *parent) : QTabWidget(parent)
 {
@@ -8,30 +14,217 @@ RightTabWidget::RightTabWidget(QWidget *parent) : QTabWidget(parent)
     this->setTabBar(tabBar);
     this->setTabsClosable(true);
     connect(this, SIGNAL(tabCloseRequested(int)), this, SLOT(close(int)));
+    connect(tabBar, SIGNAL(tabsCloseRequested(QList<int>)), this, SLOT(closeTabs(QList<int>)));
+    releaseTimer = new QTimer(this);
+    releaseTimer->setSingleShot(true);
+    releaseTimer->setInterval(300);
+    connect(releaseTimer, SIGNAL(timeout()), this, SLOT(releaseRetired()));
+    fileSystemWatcher = new QFileSystemWatcher(this);
+    connect(fileSystemWatcher, SIGNAL(fileChanged(QString)), this, SLOT(fileChanged(QString)));
+    connect(this, SIGNAL(currentChanged(int)), this, SLOT(activate(int)));
 }
 
-void RightTabWidget::close(int index)
+//idle time counts from the moment a tab was left, the current one is never idle
+void RightTabWidget::activate(int index)
 {
-    if(this->widget(index) == 0)
+    WebView *webView = qobject_cast<WebView*>(this->widget(index));
+    if(webView == activeWebView)
     {
         return;
     }
-    if(this->tabText(index).startsWith("* "))
+    if(!activeWebView.isNull())
     {
-        int r = QMessageBox::warning(this, tr("NeoEditor"),
-                                     QString("%1 has been modified.\n Do you want to save your changes?").arg(this->tabToolTip(index)),
-                                     QMessageBox::Save | QMessageBox::Discard | QMessageBox::Cancel);
-        if(r == QMessageBox::Cancel)
+        activeWebView->markActivated();
+    }
+    if(webView != 0)
+    {
+        webView->markActivated();
+    }
+    activeWebView = webView;
+}
+
+WebView *RightTabWidget::webView(const QString &filePath)
+{
+    for(int i = 0; i < this->count(); i++)
+    {
+        if(this->tabToolTip(i) == filePath)
+        {
+            return qobject_cast<WebView*>(this->widget(i));
+        }
+    }
+    return 0;
+}
+
+QHash<QString, QStringList> RightTabWidget::openBuffers()
+{
+    QHash<QString, QStringList> buffers;
+    for(int i = 0; i < this->count(); i++)
+    {
+        WebView *webView = qobject_cast<WebView*>(this->widget(i));
+        if(webView != 0)
+        {
+            buffers.insert(this->tabToolTip(i), webView->buffer()->lines());
+        }
+    }
+    return buffers;
+}
+
+void RightTabWidget::fileChanged(QString filePath)
+{
+    for(int i = 0; i < this->count(); i++)
+    {
+        if(this->tabToolTip(i) != filePath)
+        {
+            continue;
+        }
+        CsvView *csvView = qobject_cast<CsvView*>(this->widget(i));
+        if(csvView != 0)
         {
+            fileSystemWatcher->addPath(filePath);
+            csvView->reload(); //read-only, nothing to lose
             return;
         }
-        else if(r == QMessageBox::Save)
+        QFile file(filePath);
+        if(!file.open(QIODevice::ReadOnly))
+        {
+            return; //deleted, or replaced and not there yet
+        }
+        QByteArray content = file.readAll();
+        file.close();
+        fileSystemWatcher->addPath(filePath); //editors that save by rename drop the watch
+        WebView *webView = (WebView*) this->widget(i);
+        if(webView->isSavedContent(content))
+        {
+            return;
+        }
+        if(webView->isModified())
+        {
+            int r = QMessageBox::warning(this, tr("NeoEditor"),
+                                         QString("%1 has been changed on disk.\n Do you want to reload it and lose your changes?").arg(filePath),
+                                         QMessageBox::Yes | QMessageBox::No, QMessageBox::No);
+            if(r == QMessageBox::No)
+            {
+                return;
+            }
+        }
+        webView->reloadFromDisk();
+        return;
+    }
+}
+
+void RightTabWidget::close(int index)
+{
+    closeTabs(QList<int>() << index);
+}
+
+//one prompt for all modified tabs and one layout pass; false if the user cancelled
+bool RightTabWidget::closeTabs(QList<int> indexes)
+{
+    QList<QWidget*> widgets;
+    QList<WebView*> modifiedWebViews;
+    foreach(int index, indexes)
+    {
+        QWidget *widget = this->widget(index);
+        if(widget == 0 || widgets.contains(widget))
+        {
+            continue;
+        }
+        widgets << widget;
+        WebView *webView = qobject_cast<WebView*>(widget);
+        if(webView != 0 && this->tabText(index).startsWith("* "))
+        {
+            modifiedWebViews << webView;
+        }
+    }
+    if(widgets.isEmpty())
+    {
+        return true;
+    }
+    if(!modifiedWebViews.isEmpty())
+    {
+        QMessageBox messageBox(QMessageBox::Warning, tr("NeoEditor"), QString(), QMessageBox::Discard | QMessageBox::Cancel, this);
+        if(modifiedWebViews.count() == 1)
+        {
+            messageBox.setText(QString("%1 has been modified.\n Do you want to save your changes?").arg(modifiedWebViews.first()->filePath()));
+            messageBox.addButton(QMessageBox::Save);
+        }
+        else
         {
-            WebView *webView = (WebView*) this->widget(index);
-            webView->save();
+            QStringList filePaths;
+            foreach(WebView *webView, modifiedWebViews)
+            {
+                filePaths << webView->filePath();
+            }
+            messageBox.setText(tr("%1 files have been modified.\n Do you want to save your changes?").arg(modifiedWebViews.count()));
+            messageBox.setDetailedText(filePaths.join("\n"));
+            messageBox.addButton(QMessageBox::SaveAll);
+        }
+        int r = messageBox.exec();
+        if(r == QMessageBox::Cancel)
+        {
+            return false;
+        }
+        if(r == QMessageBox::Save || r == QMessageBox::SaveAll)
+        {
+            //save() gives up silently on unwritable files and partial archives, so nothing is closed then
+            QStringList failedPaths;
+            foreach(WebView *webView, modifiedWebViews)
+            {
+                webView->save();
+                if(webView->isModified())
+                {
+                    failedPaths << webView->filePath();
+                }
+            }
+            if(!failedPaths.isEmpty())
+            {
+                QMessageBox::warning(this, tr("NeoEditor"), tr("Could not save:\n%1\nNo tabs were closed.").arg(failedPaths.join("\n")));
+                return false;
+            }
         }
     }
-    this->removeTab(index);
+
+    this->setUpdatesEnabled(false);
+    this->blockSignals(true);
+    foreach(QWidget *widget, widgets)
+    {
+        int index = this->indexOf(widget);
+        WebView *webView = qobject_cast<WebView*>(widget);
+        if(webView != 0)
+        {
+            webView->cacheContent(); //recently closed files are likely to be reopened
+        }
+        fileSystemWatcher->removePath(this->tabToolTip(index));
+        this->removeTab(index);
+        retire(widget);
+    }
+    this->blockSignals(false);
+    this->setUpdatesEnabled(true);
+    emit currentChanged(this->currentIndex());
+    return true;
+}
+
+//removeTab only detaches the page, the view is destroyed later together with the others closed meanwhile
+void RightTabWidget::retire(QWidget *widget)
+{
+    widget->hide();
+    retiredWidgets << widget;
+    releaseTimer->start();
+}
+
+void RightTabWidget::releaseRetired()
+{
+    qint64 before = ResourceMonitor::residentMemory();
+    int count = retiredWidgets.count();
+    qDeleteAll(retiredWidgets);
+    retiredWidgets.clear();
+    //decoded resources of the closed pages, and the heap pages they leave empty
+    QWebSettings::clearMemoryCaches();
+#if defined(Q_OS_LINUX) && defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+    qint64 after = ResourceMonitor::residentMemory();
+    emit tabsReleased(count, before >= 0 && after >= 0 ? before - after : -1);
 }
 
 void RightTabWidget::remove(QString filePath)
@@ -40,7 +233,10 @@ void RightTabWidget::remove(QString filePath)
     {
         if(this->tabToolTip(i) == filePath)
         {
+            fileSystemWatcher->removePath(filePath);
+            QWidget *widget = this->widget(i);
             this->removeTab(i);
+            retire(widget);
             break;
         }
     }
@@ -52,6 +248,8 @@ void RightTabWidget::rename(QString oldFilePath, QString newFilePath)
     {
         if(this->tabToolTip(i) == oldFilePath)
         {
+            fileSystemWatcher->removePath(oldFilePath);
+            fileSystemWatcher->addPath(newFilePath);
             this->setTabToolTip(i, newFilePath);
             QString tabText = QFileInfo(newFilePath).fileName();
             if(this->tabText(i).startsWith("* "))
@@ -66,13 +264,19 @@ void RightTabWidget::rename(QString oldFilePath, QString newFilePath)
 
 void RightTabWidget::removeFolder(QString folderPath)
 {
+    bool updatesEnabled = this->updatesEnabled();
+    this->setUpdatesEnabled(false);
     for(int i = this->count() - 1; i >= 0; i--)
     {
         if(this->tabToolTip(i).startsWith(folderPath))
         {
+            fileSystemWatcher->removePath(this->tabToolTip(i));
+            QWidget *widget = this->widget(i);
             this->removeTab(i);
+            retire(widget);
         }
     }
+    this->setUpdatesEnabled(updatesEnabled);
 }
 
 void RightTabWidget::renameFolder(QString oldFolderPath, QString newFolderPath)
@@ -81,7 +285,62 @@ void RightTabWidget::renameFolder(QString oldFolderPath, QString newFolderPath)
     {
         if(this->tabToolTip(i).startsWith(oldFolderPath))
         {
+            fileSystemWatcher->removePath(this->tabToolTip(i));
             this->setTabToolTip(i, newFolderPath + this->tabToolTip(i).mid(oldFolderPath.length()));
+            fileSystemWatcher->addPath(this->tabToolTip(i));
+        }
+    }
+}
+
+void RightTabWidget::applyFileOperations(QList<FileOperation> results)
+{
+    //one layout pass for the whole batch
+    this->setUpdatesEnabled(false);
+    foreach(const FileOperation &operation, results)
+    {
+        if(!operation.succeeded)
+        {
+            continue;
+        }
+        if(operation.type == FileOperation::Delete)
+        {
+            if(operation.isFolder)
+            {
+                this->removeFolder(operation.sourcePath + "/");
+            }
+            else
+            {
+                this->remove(operation.sourcePath);
+            }
+        }
+        else if(operation.type == FileOperation::Rename || operation.type == FileOperation::Move)
+        {
+            if(operation.isFolder)
+            {
+                this->renameFolder(operation.sourcePath + "/", operation.targetPath + "/");
+            }
+            else
+            {
+                this->rename(operation.sourcePath, operation.targetPath);
+            }
+        }
+    }
+    this->setUpdatesEnabled(true);
+}
+
+void RightTabWidget::openAt(QString filePath, int line)
+{
+    this->open(filePath);
+    for(int i = 0; i < this->count(); i++)
+    {
+        if(filePath == this->tabToolTip(i))
+        {
+            WebView *webView = qobject_cast<WebView*>(this->widget(i));
+            if(webView != 0)
+            {
+                webView->gotoLine(line);
+            }
+            return;
         }
     }
 }
@@ -102,11 +361,22 @@ void RightTabWidget::open(QString filePath)
         }
     }
 
-    WebView *webView = new WebView(this);
-    int index = this->addTab(webView, fileInfo.fileName());
-    webView->setFocus();
+    //large exports are unusable as text, tables get a virtualized view instead of an editor
+    QWidget *widget;
+    QString suffix = fileInfo.suffix().toLower();
+    if(suffix == "csv" || suffix == "tsv")
+    {
+        widget = new CsvView(this, filePath);
+    }
+    else
+    {
+        widget = new WebView(this);
+    }
+    int index = this->addTab(widget, fileInfo.fileName());
+    widget->setFocus();
     this->setTabToolTip(index, filePath);
     this->setCurrentIndex(index);
+    fileSystemWatcher->addPath(filePath);
     if(filePath.endsWith(".rb"))
     {
         this->setTabIcon(index, QIcon(":/images/languages/ruby.png"));
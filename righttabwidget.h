@@ -3,23 +3,44 @@
 
 
 #include <QtWidgets>
+#include "fileoperationqueue.h"
+
+class WebView;
 
 class RightTabWidget : public QTabWidget
 {
     Q_OBJECT
 
+signals:
+    void tabsReleased(int count, qint64 freedBytes);
+
 public:
     RightTabWidget(QWidget *parent);
+    WebView *webView(const QString &filePath);
+    QHash<QString, QStringList> openBuffers();
 
 public slots:
     void open(QString filePath);
+    void openAt(QString filePath, int line);
     void remove(QString filePath);
     void removeFolder(QString folderPath);
     void rename(QString oldFilePath, QString newFilePath);
     void renameFolder(QString oldFolderPath, QString newFolderPath);
+    void applyFileOperations(QList<FileOperation> results);
+    bool closeTabs(QList<int> indexes);
 
 private slots:
     void close(int index);
+    void fileChanged(QString filePath);
+    void activate(int index);
+    void releaseRetired();
+
+private:
+    void retire(QWidget *widget);
+    QFileSystemWatcher *fileSystemWatcher;
+    QList<QWidget*> retiredWidgets;
+    QTimer *releaseTimer;
+    QPointer<WebView> activeWebView;
 };
 
 
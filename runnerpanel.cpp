@@ -0,0 +1,116 @@
+#include "runnerpanel.h"
+#include "outputview.h"
+#include "lefttabwidget.h"
+#include "mainwindow.h"
+
+RunnerPanel::RunnerPanel(QWidget *parent, LeftTabWidget *leftTabWidget) : QWidget(parent)
+{
+    this->leftTabWidget = leftTabWidget;
+    lineEdit = new QLineEdit();
+    lineEdit->setPlaceholderText(tr("Command to run in the current folder"));
+    connect(lineEdit, SIGNAL(returnPressed()), this, SLOT(run()));
+    runButton = new QPushButton(tr("&Run"));
+    connect(runButton, SIGNAL(clicked()), this, SLOT(run()));
+    stopButton = new QPushButton(tr("S&top"));
+    stopButton->setEnabled(false);
+    connect(stopButton, SIGNAL(clicked()), this, SLOT(stop()));
+    outputView = new OutputView(this);
+    connect(outputView, SIGNAL(locationActivated(QString, int)), this, SLOT(openLocation(QString, int)));
+
+    QHBoxLayout *commandLayout = new QHBoxLayout();
+    commandLayout->addWidget(lineEdit);
+    commandLayout->addWidget(runButton);
+    commandLayout->addWidget(stopButton);
+    QVBoxLayout *layout = new QVBoxLayout();
+    layout->addLayout(commandLayout);
+    layout->addWidget(outputView);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->setSpacing(0);
+    this->setLayout(layout);
+
+    process = new QProcess(this);
+    process->setProcessChannelMode(QProcess::MergedChannels);
+    connect(process, SIGNAL(readyRead()), this, SLOT(read()));
+    connect(process, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(finish(int, QProcess::ExitStatus)));
+    connect(process, SIGNAL(errorOccurred(QProcess::ProcessError)), this, SLOT(fail(QProcess::ProcessError)));
+}
+
+RunnerPanel::~RunnerPanel()
+{
+    if(process->state() != QProcess::NotRunning)
+    {
+        process->kill();
+        process->waitForFinished(1000);
+    }
+}
+
+void RunnerPanel::run()
+{
+    QString command = lineEdit->text().trimmed();
+    if(command.isEmpty() || process->state() != QProcess::NotRunning)
+    {
+        return;
+    }
+    int currentIndex = leftTabWidget->currentIndex();
+    folderPath = currentIndex == -1 ? QDir::homePath() : leftTabWidget->tabToolTip(currentIndex);
+    outputView->clear();
+    outputView->append(QString("$ %1\n").arg(command).toUtf8());
+    process->setWorkingDirectory(folderPath);
+    //a failed start may be reported from inside start()
+    runButton->setEnabled(false);
+    stopButton->setEnabled(true);
+#ifdef Q_OS_WIN
+    process->start("cmd", QStringList() << "/c" << command);
+#else
+    process->start("/bin/sh", QStringList() << "-c" << command);
+#endif
+}
+
+void RunnerPanel::stop()
+{
+    process->kill();
+}
+
+void RunnerPanel::read()
+{
+    outputView->append(process->readAll());
+}
+
+void RunnerPanel::finish(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    read();
+    if(exitStatus == QProcess::CrashExit)
+    {
+        outputView->append(tr("\n[killed]\n").toUtf8());
+    }
+    else
+    {
+        outputView->append(tr("\n[exit code %1]\n").arg(exitCode).toUtf8());
+    }
+    outputView->flush();
+    runButton->setEnabled(true);
+    stopButton->setEnabled(false);
+}
+
+//finished is never emitted for a process that did not start
+void RunnerPanel::fail(QProcess::ProcessError error)
+{
+    if(error != QProcess::FailedToStart)
+    {
+        return;
+    }
+    outputView->append(tr("\n[failed to start: %1]\n").arg(process->errorString()).toUtf8());
+    outputView->flush();
+    runButton->setEnabled(true);
+    stopButton->setEnabled(false);
+}
+
+void RunnerPanel::openLocation(QString path, int line)
+{
+    QFileInfo fileInfo(QDir(folderPath).absoluteFilePath(path));
+    if(!fileInfo.isFile())
+    {
+        return;
+    }
+    emit MainWindow::GetInstance()->openFileAtLineRequested(fileInfo.absoluteFilePath(), line);
+}
@@ -0,0 +1,37 @@
+#ifndef RUNNERPANEL_H
+#define RUNNERPANEL_H
+
+
+#include <QtWidgets>
+
+class LeftTabWidget;
+class OutputView;
+
+class RunnerPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    RunnerPanel(QWidget *parent, LeftTabWidget *leftTabWidget);
+    ~RunnerPanel();
+
+private slots:
+    void run();
+    void stop();
+    void read();
+    void finish(int exitCode, QProcess::ExitStatus exitStatus);
+    void fail(QProcess::ProcessError error);
+    void openLocation(QString path, int line);
+
+private:
+    LeftTabWidget *leftTabWidget;
+    QLineEdit *lineEdit;
+    QPushButton *runButton;
+    QPushButton *stopButton;
+    OutputView *outputView;
+    QProcess *process;
+    QString folderPath;
+};
+
+
+#endif // RUNNERPANEL_H
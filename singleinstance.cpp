@@ -0,0 +1,86 @@
+#include "singleinstance.h"
+
+const int SingleInstance::Timeout;
+
+SingleInstance::SingleInstance(QObject *parent) : QObject(parent)
+{
+    localServer = new QLocalServer(this);
+    connect(localServer, SIGNAL(newConnection()), this, SLOT(newConnection()));
+}
+
+QString SingleInstance::serverName()
+{
+    //one instance per user
+    QByteArray user = qgetenv("USER");
+    if(user.isEmpty())
+    {
+        user = qgetenv("USERNAME");
+    }
+    return QString("NeoEditor-%1").arg(QString(QCryptographicHash::hash(user, QCryptographicHash::Md5).toHex().left(8)));
+}
+
+bool SingleInstance::forward(const QStringList &paths)
+{
+    QLocalSocket localSocket;
+    localSocket.connectToServer(serverName(), QIODevice::WriteOnly);
+    if(!localSocket.waitForConnected(Timeout))
+    {
+        return false;
+    }
+    localSocket.write(paths.join("\n").toUtf8());
+    localSocket.write("\n\n");
+    bool written = localSocket.waitForBytesWritten(Timeout);
+    localSocket.disconnectFromServer();
+    if(localSocket.state() != QLocalSocket::UnconnectedState)
+    {
+        localSocket.waitForDisconnected(Timeout);
+    }
+    return written;
+}
+
+bool SingleInstance::listen()
+{
+    if(localServer->listen(serverName()))
+    {
+        return true;
+    }
+    //a crashed instance leaves its socket file behind, a live one still answers on it
+    if(localServer->serverError() == QAbstractSocket::AddressInUseError)
+    {
+        QLocalSocket localSocket;
+        localSocket.connectToServer(serverName(), QIODevice::WriteOnly);
+        if(localSocket.waitForConnected(Timeout))
+        {
+            localSocket.disconnectFromServer();
+            return false;
+        }
+        QLocalServer::removeServer(serverName());
+        return localServer->listen(serverName());
+    }
+    return false;
+}
+
+void SingleInstance::newConnection()
+{
+    while(localServer->hasPendingConnections())
+    {
+        QLocalSocket *localSocket = localServer->nextPendingConnection();
+        connect(localSocket, SIGNAL(readyRead()), this, SLOT(readPaths()));
+        connect(localSocket, SIGNAL(disconnected()), localSocket, SLOT(deleteLater()));
+    }
+}
+
+void SingleInstance::readPaths()
+{
+    QLocalSocket *localSocket = (QLocalSocket*)sender();
+    QByteArray data = localSocket->property("pending").toByteArray() + localSocket->readAll();
+    //the message ends with an empty line
+    if(!data.endsWith("\n\n"))
+    {
+        localSocket->setProperty("pending", data);
+        return;
+    }
+    localSocket->setProperty("pending", QByteArray());
+    //no paths means the window is only raised
+    emit pathsReceived(QString::fromUtf8(data).split("\n", QString::SkipEmptyParts));
+}
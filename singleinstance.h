@@ -0,0 +1,32 @@
+#ifndef SINGLEINSTANCE_H
+#define SINGLEINSTANCE_H
+
+
+#include <QtCore>
+#include <QtNetwork>
+
+//hands command line paths over to an already running NeoEditor through a local socket
+class SingleInstance : public QObject
+{
+    Q_OBJECT
+
+signals:
+    void pathsReceived(QStringList paths);
+
+public:
+    SingleInstance(QObject *parent = 0);
+    bool listen();
+    static bool forward(const QStringList &paths);
+    static QString serverName();
+    static const int Timeout = 500;
+
+private slots:
+    void newConnection();
+    void readPaths();
+
+private:
+    QLocalServer *localServer;
+};
+
+
+#endif // SINGLEINSTANCE_H
@@ -0,0 +1,495 @@
+#include "structureindex.h"
+
+const int StructureScanner::MaxOutlineNodes;
+const int StructureScanner::MaxOutlineDepth;
+const int StructureScanner::MaxFolds;
+
+StructureIndex::Language StructureIndex::language(const QString &filePath)
+{
+    QString suffix = QFileInfo(filePath).suffix().toLower();
+    if(suffix == "json")
+    {
+        return Json;
+    }
+    if(suffix == "xml" || suffix == "svg" || suffix == "xsd" || suffix == "xsl")
+    {
+        return Xml;
+    }
+    return None;
+}
+
+StructureScanner::StructureScanner(int version, StructureIndex::Language language, const QStringList &lines)
+{
+    this->version = version;
+    this->language = language;
+    this->lines = lines;
+    qRegisterMetaType<StructureIndexPointer>("StructureIndexPointer");
+}
+
+void StructureScanner::run()
+{
+    index = StructureIndexPointer(new StructureIndex());
+    index->errorRow = -1;
+    index->errorColumn = -1;
+    if(language == StructureIndex::Json)
+    {
+        scanJson();
+    }
+    else if(language == StructureIndex::Xml)
+    {
+        scanXml();
+    }
+    emit scanned(version, index);
+}
+
+//only the first error is kept, the structure is still followed after it
+void StructureScanner::fail(int row, int column, const QString &message)
+{
+    if(index->error.isNull())
+    {
+        index->errorRow = row;
+        index->errorColumn = column;
+        index->error = message;
+    }
+}
+
+void StructureScanner::open(Container &container, const QString &label, int row, int column, int depth)
+{
+    container.row = row;
+    container.column = column;
+    container.children = 0;
+    container.node = -1;
+    if(depth >= MaxOutlineDepth || index->outline.count() >= MaxOutlineNodes)
+    {
+        return;
+    }
+    OutlineNode node;
+    node.label = label;
+    node.row = row;
+    node.parent = -1;
+    container.node = index->outline.count();
+    index->outline.append(node);
+}
+
+void StructureScanner::close(const Container &container, int row, int column)
+{
+    if(row > container.row && index->folds.count() < MaxFolds * 4)
+    {
+        index->folds << container.row << container.column << row << column;
+    }
+}
+
+static bool isJsonNumber(const QChar *data, int length)
+{
+    int i = 0;
+    if(i < length && data[i] == '-')
+    {
+        i++;
+    }
+    if(i >= length || !data[i].isDigit())
+    {
+        return false;
+    }
+    if(data[i] == '0')
+    {
+        i++;
+    }
+    else
+    {
+        while(i < length && data[i].isDigit())
+        {
+            i++;
+        }
+    }
+    if(i < length && data[i] == '.')
+    {
+        i++;
+        int start = i;
+        while(i < length && data[i].isDigit())
+        {
+            i++;
+        }
+        if(i == start)
+        {
+            return false;
+        }
+    }
+    if(i < length && (data[i] == 'e' || data[i] == 'E'))
+    {
+        i++;
+        if(i < length && (data[i] == '+' || data[i] == '-'))
+        {
+            i++;
+        }
+        int start = i;
+        while(i < length && data[i].isDigit())
+        {
+            i++;
+        }
+        if(i == start)
+        {
+            return false;
+        }
+    }
+    return i == length;
+}
+
+static bool isJsonLiteralCharacter(QChar c)
+{
+    ushort u = c.unicode();
+    return (u >= 'a' && u <= 'z') || (u >= 'A' && u <= 'Z') || (u >= '0' && u <= '9') || u == '-' || u == '+' || u == '.';
+}
+
+void StructureScanner::scanJson()
+{
+    enum Expect
+    {
+        Value,
+        FirstValue,
+        Key,
+        FirstKey,
+        Colon,
+        CommaOrEnd,
+        End
+    };
+    QVector<Container> stack;
+    Expect expect = Value;
+    QString key;
+    int lastRow = 0;
+    int lastColumn = 0;
+    for(int row = 0; row < lines.count(); row++)
+    {
+        const QString &line = lines.at(row);
+        const QChar *data = line.constData();
+        int length = line.length();
+        for(int column = 0; column < length; column++)
+        {
+            ushort c = data[column].unicode();
+            if(c == ' ' || c == '\t' || c == '\r')
+            {
+                continue;
+            }
+            lastRow = row;
+            lastColumn = column;
+            if(c == '"')
+            {
+                //jump from quote to quote, a quote preceded by an odd number of backslashes is escaped
+                int end = column + 1;
+                while((end = line.indexOf(QChar('"'), end)) != -1)
+                {
+                    int backslashes = 0;
+                    for(int k = end - 1; k > column && data[k] == '\\'; k--)
+                    {
+                        backslashes++;
+                    }
+                    if(backslashes % 2 == 0)
+                    {
+                        break;
+                    }
+                    end++;
+                }
+                if(end == -1)
+                {
+                    fail(row, column, tr("Unterminated string"));
+                    break;
+                }
+                if(expect == Key || expect == FirstKey)
+                {
+                    key = line.mid(column + 1, qMin(end - column - 1, 80));
+                    expect = Colon;
+                }
+                else if(expect == Value || expect == FirstValue)
+                {
+                    if(!stack.isEmpty() && stack.last().type == '[')
+                    {
+                        stack.last().children++;
+                    }
+                    expect = stack.isEmpty() ? End : CommaOrEnd;
+                }
+                else
+                {
+                    fail(row, column, tr("Unexpected string"));
+                }
+                column = end;
+                continue;
+            }
+            if(c == '{' || c == '[')
+            {
+                if(expect != Value && expect != FirstValue)
+                {
+                    fail(row, column, tr("Unexpected '%1'").arg(QChar(c)));
+                }
+                QString label = "root";
+                if(!stack.isEmpty())
+                {
+                    label = stack.last().type == '{' ? key : QString("[%1]").arg(stack.last().children);
+                }
+                if(!stack.isEmpty() && stack.last().type == '[')
+                {
+                    stack.last().children++;
+                }
+                Container container;
+                container.type = QChar(c);
+                open(container, label, row, column + 1, stack.count());
+                if(container.node != -1 && !stack.isEmpty())
+                {
+                    index->outline[container.node].parent = stack.last().node;
+                }
+                stack.append(container);
+                expect = c == '{' ? FirstKey : FirstValue;
+                continue;
+            }
+            if(c == '}' || c == ']')
+            {
+                QChar type = c == '}' ? '{' : '[';
+                if(stack.isEmpty() || stack.last().type != type)
+                {
+                    fail(row, column, tr("Unexpected '%1'").arg(QChar(c)));
+                    continue;
+                }
+                if(expect != CommaOrEnd && !(c == '}' && expect == FirstKey) && !(c == ']' && expect == FirstValue))
+                {
+                    fail(row, column, tr("Unexpected '%1'").arg(QChar(c)));
+                }
+                const Container &container = stack.last();
+                close(container, row, column);
+                if(container.node != -1)
+                {
+                    index->outline[container.node].label += c == '}' ? QString(" {%1}").arg(container.children) : QString(" [%1]").arg(container.children);
+                }
+                stack.removeLast();
+                expect = stack.isEmpty() ? End : CommaOrEnd;
+                continue;
+            }
+            if(c == ':')
+            {
+                if(expect != Colon)
+                {
+                    fail(row, column, tr("Unexpected ':'"));
+                }
+                else if(!stack.isEmpty())
+                {
+                    stack.last().children++;
+                }
+                expect = Value;
+                continue;
+            }
+            if(c == ',')
+            {
+                if(expect != CommaOrEnd)
+                {
+                    fail(row, column, tr("Unexpected ','"));
+                }
+                expect = !stack.isEmpty() && stack.last().type == '{' ? Key : Value;
+                continue;
+            }
+            int end = column;
+            while(end < length && isJsonLiteralCharacter(data[end]))
+            {
+                end++;
+            }
+            if(end == column)
+            {
+                fail(row, column, tr("Unexpected character '%1'").arg(QChar(c)));
+                continue;
+            }
+            QStringRef literal = line.midRef(column, end - column);
+            if(literal != QLatin1String("true") && literal != QLatin1String("false") && literal != QLatin1String("null") && !isJsonNumber(data + column, end - column))
+            {
+                fail(row, column, tr("Invalid literal '%1'").arg(line.mid(column, qMin(end - column, 40))));
+            }
+            else if(expect != Value && expect != FirstValue)
+            {
+                fail(row, column, tr("Unexpected value"));
+            }
+            if(!stack.isEmpty() && stack.last().type == '[')
+            {
+                stack.last().children++;
+            }
+            expect = stack.isEmpty() ? End : CommaOrEnd;
+            column = end - 1;
+        }
+    }
+    if(!stack.isEmpty())
+    {
+        fail(lastRow, lastColumn, tr("Unexpected end of document, %1 not closed").arg(stack.last().type == '{' ? "'{'" : "'['"));
+    }
+    else if(expect != End)
+    {
+        fail(lastRow, lastColumn, tr("Unexpected end of document"));
+    }
+}
+
+void StructureScanner::scanXml()
+{
+    enum State
+    {
+        Text,
+        Tag,
+        Comment,
+        CData,
+        Instruction,
+        Declaration
+    };
+    QVector<Container> stack;
+    State state = Text;
+    QChar quote;
+    QString tagName;
+    bool closingTag = false;
+    bool rootClosed = false;
+    int tagRow = 0;
+    int tagColumn = 0;
+    for(int row = 0; row < lines.count(); row++)
+    {
+        const QString &line = lines.at(row);
+        const QChar *data = line.constData();
+        int length = line.length();
+        int column = 0;
+        while(column < length)
+        {
+            if(state == Text)
+            {
+                int next = line.indexOf(QChar('<'), column);
+                if(next == -1)
+                {
+                    break;
+                }
+                column = next;
+                tagRow = row;
+                tagColumn = column;
+                QStringRef rest = line.midRef(column);
+                if(rest.startsWith(QLatin1String("<!--")))
+                {
+                    state = Comment;
+                    column += 4;
+                }
+                else if(rest.startsWith(QLatin1String("<![CDATA[")))
+                {
+                    state = CData;
+                    column += 9;
+                }
+                else if(rest.startsWith(QLatin1String("<?")))
+                {
+                    state = Instruction;
+                    column += 2;
+                }
+                else if(rest.startsWith(QLatin1String("<!")))
+                {
+                    state = Declaration;
+                    column += 2;
+                }
+                else
+                {
+                    closingTag = column + 1 < length && data[column + 1] == '/';
+                    int start = column + (closingTag ? 2 : 1);
+                    int end = start;
+                    while(end < length && !data[end].isSpace() && data[end] != '/' && data[end] != '>')
+                    {
+                        end++;
+                    }
+                    tagName = line.mid(start, end - start);
+                    if(tagName.isEmpty())
+                    {
+                        fail(row, column, tr("Invalid tag"));
+                    }
+                    state = Tag;
+                    column = end;
+                }
+                continue;
+            }
+            if(state == Tag)
+            {
+                if(!quote.isNull())
+                {
+                    int end = line.indexOf(quote, column);
+                    if(end == -1)
+                    {
+                        break;
+                    }
+                    quote = QChar();
+                    column = end + 1;
+                    continue;
+                }
+                QChar c = data[column];
+                if(c == '"' || c == '\'')
+                {
+                    quote = c;
+                }
+                else if(c == '>')
+                {
+                    state = Text;
+                    bool selfClosing = column > 0 && data[column - 1] == '/';
+                    if(closingTag)
+                    {
+                        if(stack.isEmpty() || stack.last().name != tagName)
+                        {
+                            fail(tagRow, tagColumn, stack.isEmpty() ? tr("Unexpected </%1>").arg(tagName) : tr("Expected </%1> but found </%2>").arg(stack.last().name, tagName));
+                            //recover at the matching open element, if there is one
+                            int match = stack.count() - 1;
+                            while(match >= 0 && stack.at(match).name != tagName)
+                            {
+                                match--;
+                            }
+                            if(match >= 0)
+                            {
+                                stack.resize(match + 1);
+                            }
+                        }
+                        if(!stack.isEmpty() && stack.last().name == tagName)
+                        {
+                            close(stack.last(), tagRow, tagColumn);
+                            stack.removeLast();
+                            rootClosed = stack.isEmpty();
+                        }
+                    }
+                    else
+                    {
+                        if(stack.isEmpty() && rootClosed)
+                        {
+                            fail(tagRow, tagColumn, tr("More than one root element"));
+                        }
+                        if(!selfClosing)
+                        {
+                            Container container;
+                            container.type = '<';
+                            container.name = tagName;
+                            open(container, tagName, row, column + 1, stack.count());
+                            if(container.node != -1 && !stack.isEmpty())
+                            {
+                                index->outline[container.node].parent = stack.last().node;
+                            }
+                            stack.append(container);
+                        }
+                        else if(stack.isEmpty())
+                        {
+                            rootClosed = true;
+                        }
+                    }
+                }
+                column++;
+                continue;
+            }
+            const char *terminator = state == Comment ? "-->" : state == CData ? "]]>" : state == Instruction ? "?>" : ">";
+            int end = line.indexOf(QLatin1String(terminator), column);
+            if(end == -1)
+            {
+                break;
+            }
+            column = end + qstrlen(terminator);
+            state = Text;
+        }
+    }
+    int lastRow = qMax(0, lines.count() - 1);
+    if(state != Text)
+    {
+        fail(tagRow, tagColumn, tr("Unterminated markup"));
+    }
+    else if(!stack.isEmpty())
+    {
+        fail(lastRow, 0, tr("<%1> is not closed").arg(stack.last().name));
+    }
+    else if(!rootClosed)
+    {
+        fail(lastRow, 0, tr("No root element"));
+    }
+}
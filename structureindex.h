@@ -0,0 +1,72 @@
+#ifndef STRUCTUREINDEX_H
+#define STRUCTUREINDEX_H
+
+
+#include <QtCore>
+
+struct OutlineNode
+{
+    QString label;
+    int row;
+    int parent;
+};
+
+//folds, outline and the first syntax error of a JSON or XML document
+class StructureIndex
+{
+public:
+    enum Language
+    {
+        None,
+        Json,
+        Xml
+    };
+    static Language language(const QString &filePath);
+    QList<OutlineNode> outline;
+    QVector<int> folds; //startRow, startColumn, endRow, endColumn
+    int errorRow;
+    int errorColumn;
+    QString error;
+};
+
+typedef QSharedPointer<StructureIndex> StructureIndexPointer;
+Q_DECLARE_METATYPE(StructureIndexPointer)
+
+//one pass over the document; string contents are skipped with QString::indexOf, which is SIMD accelerated
+class StructureScanner : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+signals:
+    void scanned(int version, StructureIndexPointer structureIndex);
+
+public:
+    StructureScanner(int version, StructureIndex::Language language, const QStringList &lines);
+    void run();
+    static const int MaxOutlineNodes = 50000;
+    static const int MaxOutlineDepth = 8;
+    static const int MaxFolds = 500000;
+
+private:
+    struct Container
+    {
+        QChar type;
+        QString name;
+        int row;
+        int column;
+        int node;
+        int children;
+    };
+    void scanJson();
+    void scanXml();
+    void fail(int row, int column, const QString &message);
+    void open(Container &container, const QString &label, int row, int column, int depth);
+    void close(const Container &container, int row, int column);
+    int version;
+    StructureIndex::Language language;
+    QStringList lines;
+    StructureIndexPointer index;
+};
+
+
+#endif // STRUCTUREINDEX_H
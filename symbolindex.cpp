@@ -0,0 +1,487 @@
+#include "symbolindex.h"
+#include "projectfiles.h"
+
+static const quint32 TableMagic = 0x4e535958; //"NSYX"
+static const quint32 TableVersion = 1;
+static const char *Kinds[] = { "class", "function", "method", "module" };
+
+const int SymbolScanQueue::BatchSize;
+
+SymbolScanner::SymbolScanner()
+{
+    QString cpp = "c cc cpp cxx h hh hpp hxx";
+    addRule(cpp, "^\\s*(?:class|struct|namespace|enum(?:\\s+class)?)\\s+(\\w+)\\s*(?:[:{]|$)", "class");
+    //type tokens and the separators between them share no characters and are matched possessively,
+    //so a long declaration that does not match fails without backtracking through every split
+    addRule(cpp, "^(?:[\\w:<>,~]++[\\s\\*&]++)+(~?\\w+(?:::~?\\w+)*)\\s*\\([^;]*$", "function");
+    QString js = "js ts coffee";
+    addRule(js, "^\\s*(?:export\\s+)?(?:default\\s+)?(?:class|interface)\\s+(\\w+)", "class");
+    addRule(js, "^\\s*(?:export\\s+)?(?:async\\s+)?function\\s*\\*?\\s*([\\w$]+)", "function");
+    addRule(js, "^\\s*(?:var|let|const)?\\s*([\\w$.]+)\\s*[:=]\\s*(?:async\\s+)?function\\b", "function");
+    addRule(js, "^\\s+(?:static\\s+|async\\s+)*(\\w+)\\s*\\([^)]*\\)\\s*\\{\\s*$", "method");
+    addRule("py", "^\\s*class\\s+(\\w+)", "class");
+    addRule("py", "^\\s*(?:async\\s+)?def\\s+(\\w+)", "function");
+    addRule("rb", "^\\s*module\\s+([\\w:]+)", "module");
+    addRule("rb", "^\\s*class\\s+([\\w:]+)", "class");
+    addRule("rb", "^\\s*def\\s+(?:self\\.)?(\\w+[?!=]?)", "method");
+    QString java = "java cs as";
+    addRule(java, "^\\s*(?:(?:public|private|protected|internal|static|final|abstract|sealed|partial)\\s+)*(?:class|interface|enum|struct)\\s+(\\w+)", "class");
+    addRule(java, "^\\s*(?:(?:public|private|protected|internal|static|final|abstract|synchronized|virtual|override|async)\\s+)+[\\w<>\\[\\],\\.\\s]+?\\s+(\\w+)\\s*\\(", "method");
+    addRule("php", "^\\s*(?:abstract\\s+|final\\s+)?(?:class|interface|trait)\\s+(\\w+)", "class");
+    addRule("php", "^\\s*(?:(?:public|private|protected|static|abstract|final)\\s+)*function\\s+&?(\\w+)", "function");
+    addRule("go", "^type\\s+(\\w+)", "class");
+    addRule("go", "^func\\s+(?:\\([^)]*\\)\\s*)?(\\w+)", "function");
+
+    keywords << "if" << "for" << "while" << "switch" << "return" << "sizeof" << "catch" << "else" << "foreach" << "do";
+}
+
+void SymbolScanner::addRule(const QString &extensions, const QString &pattern, const QString &kind)
+{
+    Rule rule;
+    rule.regExp = QRegularExpression(pattern);
+    rule.kind = kind;
+    foreach(const QString &extension, extensions.split(' '))
+    {
+        rules[extension] << rule;
+    }
+}
+
+QList<Symbol> SymbolScanner::scan(const QString &filePath, const QString &content)
+{
+    QList<Symbol> symbols;
+    QString extension = QFileInfo(filePath).suffix().toLower();
+    if(!rules.contains(extension))
+    {
+        return symbols;
+    }
+    const QList<Rule> &fileRules = rules[extension];
+    QStringList lines = content.split('\n');
+    for(int i = 0; i < lines.count(); i++)
+    {
+        const QString &line = lines.at(i);
+        if(line.length() > 300 || line.trimmed().isEmpty())
+        {
+            continue;
+        }
+        foreach(const Rule &rule, fileRules)
+        {
+            QRegularExpressionMatch match = rule.regExp.match(line);
+            if(!match.hasMatch())
+            {
+                continue;
+            }
+            Symbol symbol;
+            symbol.name = match.captured(1);
+            symbol.kind = rule.kind;
+            int separator = qMax(symbol.name.lastIndexOf("::"), symbol.name.lastIndexOf('.'));
+            if(separator != -1)
+            {
+                symbol.name = symbol.name.mid(separator + (symbol.name.at(separator) == '.' ? 1 : 2));
+                symbol.kind = "method";
+            }
+            if(keywords.contains(symbol.name))
+            {
+                continue;
+            }
+            symbol.filePath = filePath;
+            symbol.line = i + 1;
+            symbols << symbol;
+            break;
+        }
+    }
+    return symbols;
+}
+
+SymbolScanQueue::SymbolScanQueue(const QString &folderPath, const QStringList &filePaths)
+{
+    this->folderPath = folderPath;
+    this->filePaths = filePaths;
+    this->next = 0;
+}
+
+QStringList SymbolScanQueue::take()
+{
+    int start = next.fetchAndAddOrdered(BatchSize);
+    return filePaths.mid(start, BatchSize);
+}
+
+void SymbolScanQueue::finish(const QHash<QString, SymbolTable> &tables)
+{
+    QMutexLocker locker(&mutex);
+    this->tables.unite(tables);
+}
+
+QHash<QString, SymbolTable> SymbolScanQueue::results()
+{
+    QMutexLocker locker(&mutex);
+    return tables;
+}
+
+SymbolScanWorker::SymbolScanWorker(SymbolScanQueue *queue)
+{
+    this->queue = queue;
+}
+
+void SymbolScanWorker::run()
+{
+    SymbolScanner scanner;
+    QHash<QString, SymbolTable> tables;
+    QStringList batch;
+    while(!(batch = queue->take()).isEmpty())
+    {
+        foreach(const QString &filePath, batch)
+        {
+            QFile file(filePath);
+            if(!file.open(QIODevice::ReadOnly))
+            {
+                continue;
+            }
+            QFileInfo fileInfo(file);
+            QByteArray content = file.readAll();
+            file.close();
+            SymbolTable table;
+            table.size = fileInfo.size();
+            table.modified = fileInfo.lastModified().toMSecsSinceEpoch();
+            if(ProjectFiles::isText(content))
+            {
+                table.symbols = scanner.scan(filePath, QString::fromUtf8(content));
+            }
+            tables.insert(filePath.mid(queue->folderPath.length() + 1), table);
+        }
+    }
+    queue->finish(tables);
+}
+
+FolderSymbolIndexer::FolderSymbolIndexer(QString folderPath, int generation)
+{
+    this->folderPath = folderPath;
+    this->generation = generation;
+}
+
+void FolderSymbolIndexer::run()
+{
+    //files whose size and mtime match the stored table are not scanned again
+    QHash<QString, SymbolTable> cached = SymbolIndex::load(folderPath);
+    QHash<QString, SymbolTable> tables;
+    QStringList pending;
+    foreach(const QString &filePath, ProjectFiles::list(folderPath))
+    {
+        QFileInfo fileInfo(filePath);
+        QString relativePath = filePath.mid(folderPath.length() + 1);
+        QHash<QString, SymbolTable>::const_iterator i = cached.constFind(relativePath);
+        if(i != cached.constEnd() && i.value().size == fileInfo.size() && i.value().modified == fileInfo.lastModified().toMSecsSinceEpoch())
+        {
+            tables.insert(relativePath, i.value());
+        }
+        else
+        {
+            pending << filePath;
+        }
+    }
+
+    if(!pending.isEmpty())
+    {
+        SymbolScanQueue queue(folderPath, pending);
+        QThreadPool pool;
+        for(int i = 0; i < QThread::idealThreadCount(); i++)
+        {
+            pool.start(new SymbolScanWorker(&queue));
+        }
+        pool.waitForDone();
+        tables.unite(queue.results());
+    }
+    //published before saving and both under saveMutex, so files saved during the scan end up in
+    //the tables and a FileSymbolUpdater's save can't be overwritten by the older scan
+    SymbolIndex *symbolIndex = SymbolIndex::instance();
+    QMutexLocker locker(&symbolIndex->saveMutex);
+    int merged = symbolIndex->publish(folderPath, generation, tables);
+    if(merged > 0 || !pending.isEmpty() || tables.count() != cached.count())
+    {
+        SymbolIndex::save(folderPath, tables);
+    }
+}
+
+FileSymbolUpdater::FileSymbolUpdater(QString filePath)
+{
+    this->filePath = filePath;
+}
+
+void FileSymbolUpdater::run()
+{
+    QFileInfo fileInfo(filePath);
+    QFile file(filePath);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return;
+    }
+    QByteArray content = file.readAll();
+    file.close();
+    SymbolTable table;
+    table.size = fileInfo.size();
+    table.modified = fileInfo.lastModified().toMSecsSinceEpoch();
+    if(ProjectFiles::isText(content))
+    {
+        SymbolScanner scanner;
+        table.symbols = scanner.scan(filePath, QString::fromUtf8(content));
+    }
+
+    //saves of quick successive updates must not overtake each other
+    SymbolIndex *symbolIndex = SymbolIndex::instance();
+    QMutexLocker locker(&symbolIndex->saveMutex);
+    QHash<QString, QHash<QString, SymbolTable> > changed = symbolIndex->replace(filePath, table);
+    QHash<QString, QHash<QString, SymbolTable> >::const_iterator i;
+    for(i = changed.constBegin(); i != changed.constEnd(); ++i)
+    {
+        SymbolIndex::save(i.key(), i.value());
+    }
+}
+
+SymbolIndex::SymbolIndex()
+{
+    nextGeneration = 0;
+}
+
+SymbolIndex *SymbolIndex::instance()
+{
+    static SymbolIndex symbolIndex;
+    return &symbolIndex;
+}
+
+QString SymbolIndex::tablePath(const QString &folderPath)
+{
+    QString hash = QCryptographicHash::hash(folderPath.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QString("%1/symbols/%2.idx").arg(QStandardPaths::writableLocation(QStandardPaths::CacheLocation), hash);
+}
+
+QHash<QString, SymbolTable> SymbolIndex::load(const QString &folderPath)
+{
+    QHash<QString, SymbolTable> tables;
+    QFile file(tablePath(folderPath));
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return tables;
+    }
+    QDataStream stream(&file);
+    quint32 magic, version, fileCount;
+    stream >> magic >> version;
+    if(magic != TableMagic || version != TableVersion)
+    {
+        return tables;
+    }
+    stream >> fileCount;
+    for(quint32 i = 0; i < fileCount && stream.status() == QDataStream::Ok; i++)
+    {
+        QByteArray relativePath;
+        quint32 symbolCount;
+        SymbolTable table;
+        stream >> relativePath >> table.size >> table.modified >> symbolCount;
+        QString filePath = folderPath + "/" + QString::fromUtf8(relativePath);
+        for(quint32 j = 0; j < symbolCount && stream.status() == QDataStream::Ok; j++)
+        {
+            QByteArray name;
+            quint8 kind;
+            qint32 line;
+            stream >> name >> kind >> line;
+            Symbol symbol;
+            symbol.name = QString::fromUtf8(name);
+            symbol.kind = Kinds[qMin((int)kind, 3)];
+            symbol.filePath = filePath;
+            symbol.line = line;
+            table.symbols << symbol;
+        }
+        tables.insert(QString::fromUtf8(relativePath), table);
+    }
+    if(stream.status() != QDataStream::Ok)
+    {
+        tables.clear();
+    }
+    return tables;
+}
+
+void SymbolIndex::save(const QString &folderPath, const QHash<QString, SymbolTable> &tables)
+{
+    QString filePath = tablePath(folderPath);
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    QSaveFile file(filePath);
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        return;
+    }
+    QDataStream stream(&file);
+    stream << TableMagic << TableVersion << (quint32)tables.count();
+    QHash<QString, SymbolTable>::const_iterator i;
+    for(i = tables.constBegin(); i != tables.constEnd(); ++i)
+    {
+        stream << i.key().toUtf8() << i.value().size << i.value().modified << (quint32)i.value().symbols.count();
+        foreach(const Symbol &symbol, i.value().symbols)
+        {
+            quint8 kind = 0;
+            while(kind < 3 && symbol.kind != Kinds[kind])
+            {
+                kind++;
+            }
+            stream << symbol.name.toUtf8() << kind << (qint32)symbol.line;
+        }
+    }
+    file.commit();
+}
+
+void SymbolIndex::addFolder(const QString &folderPath)
+{
+    int generation;
+    {
+        QWriteLocker locker(&lock);
+        if(folderGenerations.contains(folderPath))
+        {
+            return;
+        }
+        generation = nextGeneration++;
+        folderGenerations.insert(folderPath, generation);
+    }
+    QThreadPool::globalInstance()->start(new FolderSymbolIndexer(folderPath, generation));
+}
+
+//merges the files saved during the scan into tables and makes them searchable,
+//returns how many were merged, -1 when the folder was closed in the meantime
+int SymbolIndex::publish(const QString &folderPath, int generation, QHash<QString, SymbolTable> &tables)
+{
+    QWriteLocker locker(&lock);
+    if(folderGenerations.value(folderPath, -1) != generation)
+    {
+        return -1; //folder closed while it was being indexed
+    }
+    int merged = 0;
+    QHash<QString, SymbolTable>::iterator pendingFile = pendingFiles.begin();
+    while(pendingFile != pendingFiles.end())
+    {
+        if(!pendingFile.key().startsWith(folderPath + "/"))
+        {
+            ++pendingFile;
+            continue;
+        }
+        tables.insert(pendingFile.key().mid(folderPath.length() + 1), pendingFile.value());
+        merged++;
+        pendingFile = isIndexing(pendingFile.key(), folderPath) ? pendingFile + 1 : pendingFiles.erase(pendingFile);
+    }
+    folders.insert(folderPath, tables);
+    foreach(const SymbolTable &table, tables)
+    {
+        foreach(const Symbol &symbol, table.symbols)
+        {
+            names.insert(symbol.name, symbol);
+        }
+    }
+    return merged;
+}
+
+void SymbolIndex::removeFolder(const QString &folderPath)
+{
+    QWriteLocker locker(&lock);
+    folderGenerations.remove(folderPath);
+    folders.remove(folderPath);
+    QHash<QString, SymbolTable>::iterator pendingFile = pendingFiles.begin();
+    while(pendingFile != pendingFiles.end())
+    {
+        pendingFile = isIndexing(pendingFile.key()) ? pendingFile + 1 : pendingFiles.erase(pendingFile);
+    }
+    names.clear();
+    foreach(const QString &folder, folders.keys())
+    {
+        foreach(const SymbolTable &table, folders.value(folder))
+        {
+            foreach(const Symbol &symbol, table.symbols)
+            {
+                names.insert(symbol.name, symbol);
+            }
+        }
+    }
+}
+
+void SymbolIndex::updateFile(const QString &filePath)
+{
+    QThreadPool::globalInstance()->start(new FileSymbolUpdater(filePath));
+}
+
+//swaps the table of one file in every folder containing it, returns those folders' tables to be saved
+QHash<QString, QHash<QString, SymbolTable> > SymbolIndex::replace(const QString &filePath, const SymbolTable &table)
+{
+    QHash<QString, QHash<QString, SymbolTable> > changed;
+    QWriteLocker locker(&lock);
+    QHash<QString, QHash<QString, SymbolTable> >::iterator folder;
+    for(folder = folders.begin(); folder != folders.end(); ++folder)
+    {
+        if(!filePath.startsWith(folder.key() + "/"))
+        {
+            continue;
+        }
+        QString relativePath = filePath.mid(folder.key().length() + 1);
+        foreach(const Symbol &symbol, folder.value().value(relativePath).symbols)
+        {
+            QMultiHash<QString, Symbol>::iterator i = names.find(symbol.name);
+            while(i != names.end() && i.key() == symbol.name)
+            {
+                if(i.value().filePath == filePath)
+                {
+                    i = names.erase(i);
+                }
+                else
+                {
+                    ++i;
+                }
+            }
+        }
+        folder.value().insert(relativePath, table);
+        foreach(const Symbol &symbol, table.symbols)
+        {
+            names.insert(symbol.name, symbol);
+        }
+        changed.insert(folder.key(), folder.value());
+    }
+    //the scan of a folder still being indexed may have read the file before it was saved
+    if(isIndexing(filePath))
+    {
+        pendingFiles.insert(filePath, table);
+    }
+    return changed;
+}
+
+//whether a folder containing filePath is still being indexed, called with lock held
+bool SymbolIndex::isIndexing(const QString &filePath, const QString &exceptFolderPath) const
+{
+    foreach(const QString &folderPath, folderGenerations.keys())
+    {
+        if(folderPath != exceptFolderPath && !folders.contains(folderPath) && filePath.startsWith(folderPath + "/"))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+QList<Symbol> SymbolIndex::definitions(const QString &name)
+{
+    QReadLocker locker(&lock);
+    return names.values(name);
+}
+
+QList<Symbol> SymbolIndex::find(const QString &text, int limit)
+{
+    //names starting with the text come first, then names containing it
+    QList<Symbol> prefixed;
+    QList<Symbol> contained;
+    QReadLocker locker(&lock);
+    QMultiHash<QString, Symbol>::const_iterator i;
+    for(i = names.constBegin(); i != names.constEnd() && prefixed.count() < limit; ++i)
+    {
+        int index = i.key().indexOf(text, 0, Qt::CaseInsensitive);
+        if(index == 0)
+        {
+            prefixed << i.value();
+        }
+        else if(index > 0 && contained.count() < limit)
+        {
+            contained << i.value();
+        }
+    }
+    return (prefixed + contained).mid(0, limit);
+}
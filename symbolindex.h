@@ -0,0 +1,121 @@
+#ifndef SYMBOLINDEX_H
+#define SYMBOLINDEX_H
+
+
+#include <QtCore>
+
+struct Symbol
+{
+    QString name;
+    QString kind;
+    QString filePath;
+    int line;
+};
+
+//definitions found in one file, together with the stat data they were scanned from
+struct SymbolTable
+{
+    qint64 size;
+    qint64 modified;
+    QList<Symbol> symbols;
+};
+
+//lightweight per-language definition scanner, one instance per worker thread
+class SymbolScanner
+{
+public:
+    SymbolScanner();
+    QList<Symbol> scan(const QString &filePath, const QString &content);
+
+private:
+    struct Rule
+    {
+        QRegularExpression regExp;
+        QString kind;
+    };
+    void addRule(const QString &extensions, const QString &pattern, const QString &kind);
+    QHash<QString, QList<Rule> > rules;
+    QSet<QString> keywords;
+};
+
+//files of one folder handed out in small batches to whichever worker asks first
+class SymbolScanQueue
+{
+public:
+    SymbolScanQueue(const QString &folderPath, const QStringList &filePaths);
+    QStringList take();
+    void finish(const QHash<QString, SymbolTable> &tables);
+    QHash<QString, SymbolTable> results();
+    QString folderPath;
+
+private:
+    QStringList filePaths;
+    QAtomicInt next;
+    QMutex mutex;
+    QHash<QString, SymbolTable> tables;
+    static const int BatchSize = 16;
+};
+
+class SymbolScanWorker : public QRunnable
+{
+public:
+    SymbolScanWorker(SymbolScanQueue *queue);
+    void run();
+
+private:
+    SymbolScanQueue *queue;
+};
+
+class FolderSymbolIndexer : public QRunnable
+{
+public:
+    FolderSymbolIndexer(QString folderPath, int generation);
+    void run();
+
+private:
+    QString folderPath;
+    int generation;
+};
+
+//rescans one saved file and writes the folder's table back to disk
+class FileSymbolUpdater : public QRunnable
+{
+public:
+    FileSymbolUpdater(QString filePath);
+    void run();
+
+private:
+    QString filePath;
+};
+
+class SymbolIndex
+{
+public:
+    static SymbolIndex *instance();
+    void addFolder(const QString &folderPath);
+    void removeFolder(const QString &folderPath);
+    void updateFile(const QString &filePath);
+    QList<Symbol> definitions(const QString &name);
+    QList<Symbol> find(const QString &text, int limit);
+    static QHash<QString, SymbolTable> load(const QString &folderPath);
+    static void save(const QString &folderPath, const QHash<QString, SymbolTable> &tables);
+
+private:
+    SymbolIndex();
+    static QString tablePath(const QString &folderPath);
+    int publish(const QString &folderPath, int generation, QHash<QString, SymbolTable> &tables);
+    QHash<QString, QHash<QString, SymbolTable> > replace(const QString &filePath, const SymbolTable &table);
+    bool isIndexing(const QString &filePath, const QString &exceptFolderPath = QString()) const;
+    QHash<QString, QHash<QString, SymbolTable> > folders;
+    QMultiHash<QString, Symbol> names;
+    QHash<QString, int> folderGenerations;
+    QHash<QString, SymbolTable> pendingFiles; //saved while a folder containing them was still being indexed
+    int nextGeneration;
+    QReadWriteLock lock;
+    QMutex saveMutex;
+    friend class FolderSymbolIndexer;
+    friend class FileSymbolUpdater;
+};
+
+
+#endif // SYMBOLINDEX_H
@@ -64,14 +64,15 @@ void TabBar::closeOthers()
     QObject *object = sender(); //action
     QObject *parent = object->parent();
     int index = tabWidget->indexOf((QWidget*)parent);
+    QList<int> indexes;
     for(int i = this->count() - 1; i >= 0; i--)
     {
-        if(i == index)
+        if(i != index)
         {
-            continue;
+            indexes << i;
         }
-        emit tabWidget->tabCloseRequested(i);
     }
+    closeTabs(indexes);
 }
 
 void TabBar::closeTabsToTheRight()
@@ -79,8 +80,24 @@ void TabBar::closeTabsToTheRight()
     QObject *object = sender(); //action
     QObject *parent = object->parent();
     int index = tabWidget->indexOf((QWidget*)parent);
+    QList<int> indexes;
     for(int i = this->count() - 1; i > index; i--)
     {
-        emit tabWidget->tabCloseRequested(i);
+        indexes << i;
+    }
+    closeTabs(indexes);
+}
+
+//indexes from the last tab to the first, so closing one does not shift the next
+void TabBar::closeTabs(const QList<int> &indexes)
+{
+    if(this->receivers(SIGNAL(tabsCloseRequested(QList<int>))) > 0)
+    {
+        emit tabsCloseRequested(indexes);
+        return;
+    }
+    foreach(int index, indexes)
+    {
+        emit tabWidget->tabCloseRequested(index);
     }
 }
@@ -8,6 +8,10 @@ class TabBar : public QTabBar
 {
     Q_OBJECT
 
+signals:
+    //bulk closes, so the tab widget can prompt and lay out once
+    void tabsCloseRequested(QList<int> indexes);
+
 public:
     TabBar(QTabWidget *parent);
 
@@ -22,6 +26,9 @@ private slots:
     void close();
     void closeOthers();
     void closeTabsToTheRight();
+
+private:
+    void closeTabs(const QList<int> &indexes);
 };
 
 
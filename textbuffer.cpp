@@ -0,0 +1,143 @@
+#include "textbuffer.h"
+
+TextBuffer::TextBuffer(QObject *parent) : QObject(parent)
+{
+    mLines << QString();
+    mLength = 0;
+}
+
+void TextBuffer::setText(const QString &text)
+{
+    QStringList removedLines = mLines;
+    mLines = splitLines(text);
+    mLength = mLines.count() - 1;
+    foreach(const QString &line, mLines)
+    {
+        mLength += line.length();
+    }
+    emit changed(0, removedLines, mLines);
+}
+
+void TextBuffer::insert(int row, int column, const QString &text)
+{
+    row = qBound(0, row, mLines.count() - 1);
+    QString line = mLines.at(row);
+    column = qBound(0, column, line.length());
+    QStringList insertedLines = splitLines(text);
+    insertedLines.first().prepend(line.left(column));
+    insertedLines.last().append(line.mid(column));
+    QStringList removedLines;
+    removedLines << line;
+    if(insertedLines.count() == 1)
+    {
+        mLines[row] = insertedLines.first();
+    }
+    else //rebuild once instead of shifting the tail for every inserted line
+    {
+        QStringList lines = mLines.mid(0, row);
+        lines += insertedLines;
+        lines += mLines.mid(row + 1);
+        mLines = lines;
+    }
+    mLength += insertedLines.count() - 1;
+    foreach(const QString &insertedLine, insertedLines)
+    {
+        mLength += insertedLine.length();
+    }
+    mLength -= line.length();
+    emit changed(row, removedLines, insertedLines);
+}
+
+void TextBuffer::remove(int startRow, int startColumn, int endRow, int endColumn)
+{
+    startRow = qBound(0, startRow, mLines.count() - 1);
+    endRow = qBound(startRow, endRow, mLines.count());
+    if(endRow == mLines.count()) //Ace's removeLines up to the last row deletes those rows entirely
+    {
+        QStringList removedLines = mLines.mid(startRow);
+        mLines.erase(mLines.begin() + startRow, mLines.end());
+        QStringList insertedLines;
+        if(mLines.isEmpty()) //an empty document still has its one empty line
+        {
+            mLines << QString();
+            insertedLines << QString();
+        }
+        foreach(const QString &removedLine, removedLines)
+        {
+            mLength -= removedLine.length() + 1; //each removed row took the newline before it
+        }
+        if(startRow == 0)
+        {
+            mLength = 0;
+        }
+        emit changed(startRow, removedLines, insertedLines);
+        return;
+    }
+    QStringList removedLines = mLines.mid(startRow, endRow - startRow + 1);
+    QString line = removedLines.first().left(startColumn) + removedLines.last().mid(endColumn);
+    mLines.erase(mLines.begin() + startRow + 1, mLines.begin() + endRow + 1);
+    mLines[startRow] = line;
+    foreach(const QString &removedLine, removedLines)
+    {
+        mLength -= removedLine.length();
+    }
+    mLength -= removedLines.count() - 1;
+    mLength += line.length();
+    QStringList insertedLines;
+    insertedLines << line;
+    emit changed(startRow, removedLines, insertedLines);
+}
+
+QString TextBuffer::text() const
+{
+    return mLines.join("\n");
+}
+
+const QStringList &TextBuffer::lines() const
+{
+    return mLines;
+}
+
+int TextBuffer::lineCount() const
+{
+    return mLines.count();
+}
+
+int TextBuffer::length() const
+{
+    return mLength;
+}
+
+//terminators, when given, receives each line's original terminator, empty for the last line
+QStringList TextBuffer::splitLines(const QString &text, QStringList *terminators)
+{
+    //same line splitting rules as Ace's Document.$split
+    QStringList lines;
+    const QChar *data = text.constData();
+    int length = text.length();
+    int lineStart = 0;
+    for(int i = 0; i < length; i++)
+    {
+        ushort c = data[i].unicode();
+        if(c == '\n' || c == '\r')
+        {
+            lines << QString(data + lineStart, i - lineStart);
+            int lineEnd = i;
+            if(c == '\r' && i + 1 < length && data[i + 1].unicode() == '\n')
+            {
+                i++;
+            }
+            if(terminators != 0)
+            {
+                *terminators << QString(data + lineEnd, i + 1 - lineEnd);
+            }
+            lineStart = i + 1;
+        }
+    }
+    lines << QString(data + lineStart, length - lineStart);
+    if(terminators != 0)
+    {
+        *terminators << QString();
+    }
+    return lines;
+}
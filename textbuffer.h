@@ -0,0 +1,33 @@
+#ifndef TEXTBUFFER_H
+#define TEXTBUFFER_H
+
+
+#include <QtCore>
+
+//native copy of an editor document, kept in sync with Ace through change deltas
+class TextBuffer : public QObject
+{
+    Q_OBJECT
+
+signals:
+    //lines [row, row + removedLines.count()) were replaced by insertedLines
+    void changed(int row, QStringList removedLines, QStringList insertedLines);
+
+public:
+    TextBuffer(QObject *parent);
+    void setText(const QString &text);
+    void insert(int row, int column, const QString &text);
+    void remove(int startRow, int startColumn, int endRow, int endColumn);
+    QString text() const;
+    const QStringList &lines() const;
+    int lineCount() const;
+    int length() const;
+    static QStringList splitLines(const QString &text, QStringList *terminators = 0);
+
+private:
+    QStringList mLines;
+    int mLength;
+};
+
+
+#endif // TEXTBUFFER_H
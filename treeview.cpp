@@ -1,10 +1,16 @@
 #include "mainwindow.h"
 #include "treeview.h"
 #include "fileiconprovider.h"
+#include "fileoperationqueue.h"
+#include "projectmodel.h"
+#include "gitstatus.h"
+#include "contentcache.h"
+#include "gitignore.h"
 
 TreeView::TreeView(QWidget* parent, QString folderPath) : QTreeView(parent)
 {
-    QFileSystemModel *fileSystemModel = new QFileSystemModel(this);
+    GitIgnore::instance()->addProjectFolder(folderPath);
+    ProjectModel *fileSystemModel = new ProjectModel(this);
     fileSystemModel->setRootPath(folderPath);
     FileIconProvider *fileIconProvider = new  FileIconProvider();
     fileSystemModel->setIconProvider(fileIconProvider);
@@ -17,6 +23,64 @@ TreeView::TreeView(QWidget* parent, QString folderPath) : QTreeView(parent)
     this->setHeaderHidden(true);
     this->setContextMenuPolicy(Qt::CustomContextMenu);
     connect(this, SIGNAL(customContextMenuRequested(const QPoint &)), this, SLOT(showContextMenu(const QPoint &)));
+    this->setDragDropMode(QAbstractItemView::DragDrop);
+    this->setDragEnabled(true);
+    this->setAcceptDrops(true);
+    this->setDropIndicatorShown(true);
+
+    //git decorations are computed in the background and refreshed from the model's own file notifications
+    gitStatus = new GitStatus(this, folderPath);
+    this->setItemDelegate(new GitStatusDelegate(this, gitStatus));
+    connect(gitStatus, SIGNAL(changed()), this->viewport(), SLOT(update()));
+    connect(fileSystemModel, SIGNAL(dataChanged(QModelIndex, QModelIndex)), this, SLOT(filesChanged(QModelIndex, QModelIndex)));
+    connect(fileSystemModel, SIGNAL(rowsAboutToBeRemoved(QModelIndex, int, int)), this, SLOT(filesRemoved(QModelIndex, int, int)));
+
+    //a file the mouse rests on is read ahead, it is probably the next one opened
+    hoverTimer = new QTimer(this);
+    hoverTimer->setSingleShot(true);
+    hoverTimer->setInterval(250);
+    connect(hoverTimer, SIGNAL(timeout()), this, SLOT(prefetchHovered()));
+    this->setMouseTracking(true);
+    connect(this, SIGNAL(entered(QModelIndex)), this, SLOT(hover(QModelIndex)));
+}
+
+void TreeView::hover(const QModelIndex &modelIndex)
+{
+    QFileSystemModel *fileSystemModel = (QFileSystemModel*)this->model();
+    if(fileSystemModel->isDir(modelIndex))
+    {
+        hoverTimer->stop();
+        return;
+    }
+    hoveredPath = fileSystemModel->filePath(modelIndex);
+    hoverTimer->start();
+}
+
+void TreeView::prefetchHovered()
+{
+    ContentCache::instance()->prefetch(hoveredPath);
+}
+
+void TreeView::filesChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    QFileSystemModel *fileSystemModel = (QFileSystemModel*)this->model();
+    QStringList paths;
+    for(int row = topLeft.row(); row <= bottomRight.row(); row++)
+    {
+        paths << fileSystemModel->filePath(topLeft.sibling(row, 0));
+    }
+    gitStatus->refresh(paths);
+}
+
+void TreeView::filesRemoved(const QModelIndex &parent, int first, int last)
+{
+    QFileSystemModel *fileSystemModel = (QFileSystemModel*)this->model();
+    QStringList paths;
+    for(int row = first; row <= last; row++)
+    {
+        paths << fileSystemModel->filePath(fileSystemModel->index(row, 0, parent));
+    }
+    gitStatus->refresh(paths);
 }
 
 void TreeView::showContextMenu(const QPoint &point)
@@ -35,6 +99,26 @@ void TreeView::showContextMenu(const QPoint &point)
     }
 
     QMenu menu(this);
+    if(currentIndex != this->rootIndex())
+    {
+        QAction *copyAction = new QAction(tr("&Copy"), &menu);
+        connect(copyAction, SIGNAL(triggered()), this, SLOT(copy()));
+        menu.addAction(copyAction);
+
+        QAction *cutAction = new QAction(tr("Cu&t"), &menu);
+        connect(cutAction, SIGNAL(triggered()), this, SLOT(cut()));
+        menu.addAction(cutAction);
+    }
+    if(fileInfo.isDir() && QApplication::clipboard()->mimeData()->hasUrls())
+    {
+        QAction *pasteAction = new QAction(tr("&Paste"), &menu);
+        connect(pasteAction, SIGNAL(triggered()), this, SLOT(paste()));
+        menu.addAction(pasteAction);
+    }
+    if(!menu.isEmpty())
+    {
+        menu.addSeparator();
+    }
     if(fileInfo.isFile())
     {
         QAction *deleteFileAction = new QAction(tr("&Delete File"), &menu);
@@ -66,9 +150,22 @@ void TreeView::showContextMenu(const QPoint &point)
             menu.addAction(renameFolderAction);
         }
     }
+    menu.addSeparator();
+    ProjectModel *projectModel = (ProjectModel*)this->model();
+    QAction *showIgnoredAction = new QAction(tr("Show &Ignored Folders"), &menu);
+    showIgnoredAction->setCheckable(true);
+    showIgnoredAction->setChecked(projectModel->showIgnored());
+    connect(showIgnoredAction, SIGNAL(toggled(bool)), this, SLOT(showIgnored(bool)));
+    menu.addAction(showIgnoredAction);
     menu.exec(this->mapToGlobal(point));
 }
 
+void TreeView::showIgnored(bool showIgnored)
+{
+    ProjectModel *projectModel = (ProjectModel*)this->model();
+    projectModel->setShowIgnored(showIgnored);
+}
+
 void TreeView::deleteFile()
 {
     QFileSystemModel *fileSystemModel = (QFileSystemModel*)this->model();
@@ -84,11 +181,10 @@ void TreeView::deleteFile()
     {
         return;
     }
-    bool r = fileSystemModel->remove(this->currentIndex());
-    if(r)
-    {
-        emit MainWindow::GetInstance()->deleteFileRequested(filePath);
-    }
+    FileOperation operation;
+    operation.type = FileOperation::Delete;
+    operation.sourcePath = filePath;
+    emit MainWindow::GetInstance()->fileOperationsRequested(QList<FileOperation>() << operation);
 }
 
 void TreeView::renameFile()
@@ -105,13 +201,11 @@ void TreeView::renameFile()
     {
         return;
     }
-    QFile file(filePath);
-    QString newFilePath = QDir(fileInfo.absolutePath()).absoluteFilePath(fileName);
-    bool r = file.rename(newFilePath);
-    if(r)
-    {
-        emit MainWindow::GetInstance()->renameFileRequested(filePath, newFilePath);
-    }
+    FileOperation operation;
+    operation.type = FileOperation::Rename;
+    operation.sourcePath = filePath;
+    operation.targetPath = QDir(fileInfo.absolutePath()).absoluteFilePath(fileName);
+    emit MainWindow::GetInstance()->fileOperationsRequested(QList<FileOperation>() << operation);
 }
 
 void TreeView::newFile()
@@ -174,11 +268,10 @@ void TreeView::deleteFolder()
     {
         return;
     }
-    bool r = fileSystemModel->remove(this->currentIndex());
-    if(r)
-    {
-        emit MainWindow::GetInstance()->deleteFolderRequested(folderPath);
-    }
+    FileOperation operation;
+    operation.type = FileOperation::Delete;
+    operation.sourcePath = folderPath;
+    emit MainWindow::GetInstance()->fileOperationsRequested(QList<FileOperation>() << operation);
 }
 
 void TreeView::renameFolder()
@@ -195,11 +288,111 @@ void TreeView::renameFolder()
     {
         return;
     }
-    QString newFolderPath = fileInfo.absoluteDir().absoluteFilePath(folderName);
-    QDir dir;
-    bool r = dir.rename(folderPath, newFolderPath);
-    if(r)
+    FileOperation operation;
+    operation.type = FileOperation::Rename;
+    operation.sourcePath = folderPath;
+    operation.targetPath = fileInfo.absoluteDir().absoluteFilePath(folderName);
+    emit MainWindow::GetInstance()->fileOperationsRequested(QList<FileOperation>() << operation);
+}
+
+void TreeView::copy()
+{
+    QFileSystemModel *fileSystemModel = (QFileSystemModel*)this->model();
+    QMimeData *mimeData = new QMimeData();
+    mimeData->setUrls(QList<QUrl>() << QUrl::fromLocalFile(fileSystemModel->filePath(this->currentIndex())));
+    QApplication::clipboard()->setMimeData(mimeData);
+}
+
+void TreeView::cut()
+{
+    QFileSystemModel *fileSystemModel = (QFileSystemModel*)this->model();
+    QMimeData *mimeData = new QMimeData();
+    mimeData->setUrls(QList<QUrl>() << QUrl::fromLocalFile(fileSystemModel->filePath(this->currentIndex())));
+    mimeData->setData("application/x-neoeditor-cut", "1");
+    QApplication::clipboard()->setMimeData(mimeData);
+}
+
+void TreeView::paste()
+{
+    QFileSystemModel *fileSystemModel = (QFileSystemModel*)this->model();
+    QFileInfo fileInfo = fileSystemModel->fileInfo(this->currentIndex());
+    if(!fileInfo.isDir())
+    {
+        return;
+    }
+    const QMimeData *mimeData = QApplication::clipboard()->mimeData();
+    bool move = mimeData->hasFormat("application/x-neoeditor-cut");
+    transfer(mimeData->urls(), fileInfo.absoluteFilePath(), move);
+    if(move)
+    {
+        QApplication::clipboard()->clear();
+    }
+}
+
+void TreeView::transfer(QList<QUrl> urls, QString folderPath, bool move)
+{
+    QList<FileOperation> batch;
+    foreach(const QUrl &url, urls)
+    {
+        if(!url.isLocalFile())
+        {
+            continue;
+        }
+        FileOperation operation;
+        operation.type = move ? FileOperation::Move : FileOperation::Copy;
+        operation.sourcePath = QFileInfo(url.toLocalFile()).absoluteFilePath();
+        operation.targetPath = QDir(folderPath).absoluteFilePath(QFileInfo(operation.sourcePath).fileName());
+        if(operation.sourcePath == operation.targetPath)
+        {
+            continue;
+        }
+        batch << operation;
+    }
+    emit MainWindow::GetInstance()->fileOperationsRequested(batch);
+}
+
+QString TreeView::dropFolder(const QPoint &point)
+{
+    QFileSystemModel *fileSystemModel = (QFileSystemModel*)this->model();
+    QModelIndex index = this->indexAt(point);
+    if(!index.isValid())
+    {
+        index = this->rootIndex();
+    }
+    QFileInfo fileInfo = fileSystemModel->fileInfo(index);
+    return fileInfo.isDir() ? fileInfo.absoluteFilePath() : fileInfo.absolutePath();
+}
+
+void TreeView::dragEnterEvent(QDragEnterEvent *dragEnterEvent)
+{
+    if(dragEnterEvent->mimeData()->hasUrls())
     {
-        emit MainWindow::GetInstance()->renameFolderRequested(folderPath, newFolderPath);
+        dragEnterEvent->acceptProposedAction();
+    }
+}
+
+void TreeView::dragMoveEvent(QDragMoveEvent *dragMoveEvent)
+{
+    QTreeView::dragMoveEvent(dragMoveEvent);
+    if(dragMoveEvent->mimeData()->hasUrls())
+    {
+        dragMoveEvent->setDropAction(dragMoveEvent->keyboardModifiers() & Qt::ControlModifier ? Qt::CopyAction : Qt::MoveAction);
+        dragMoveEvent->accept();
+    }
+}
+
+void TreeView::dropEvent(QDropEvent *dropEvent)
+{
+    //the model would move files synchronously on the GUI thread, the queue does it instead
+    if(!dropEvent->mimeData()->hasUrls())
+    {
+        return;
     }
+    bool move = !(dropEvent->keyboardModifiers() & Qt::ControlModifier);
+    transfer(dropEvent->mimeData()->urls(), dropFolder(dropEvent->pos()), move);
+    dropEvent->setDropAction(Qt::CopyAction);
+    dropEvent->accept();
+    this->stopAutoScroll();
+    this->setState(QAbstractItemView::NoState);
+    this->viewport()->update();
 }
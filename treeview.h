@@ -4,6 +4,8 @@
 
 #include <QtWidgets>
 
+class GitStatus;
+
 class TreeView : public QTreeView
 {
     Q_OBJECT
@@ -11,14 +13,34 @@ class TreeView : public QTreeView
 public:
     TreeView(QWidget* parent, QString folderPath);
 
+protected:
+    void dragEnterEvent(QDragEnterEvent *dragEnterEvent);
+    void dragMoveEvent(QDragMoveEvent *dragMoveEvent);
+    void dropEvent(QDropEvent *dropEvent);
+
 private slots:
     void showContextMenu(const QPoint &point);
+    void showIgnored(bool showIgnored);
+    void filesChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void filesRemoved(const QModelIndex &parent, int first, int last);
+    void hover(const QModelIndex &modelIndex);
+    void prefetchHovered();
     void deleteFile();
     void renameFile();
     void newFile();
     void newFolder();
     void deleteFolder();
     void renameFolder();
+    void copy();
+    void cut();
+    void paste();
+
+private:
+    void transfer(QList<QUrl> urls, QString folderPath, bool move);
+    QString dropFolder(const QPoint &point);
+    GitStatus *gitStatus;
+    QTimer *hoverTimer;
+    QString hoveredPath;
 };
 
 
@@ -0,0 +1,207 @@
+#include "typingbenchmark.h"
+#include "webview.h"
+#include "textbuffer.h"
+#include <algorithm>
+
+const int TypingBenchmark::Keystrokes;
+const int TypingBenchmark::KeyInterval;
+const int TypingBenchmark::Timeout;
+const int TypingBenchmark::LoadTimeout;
+
+TypingBenchmark::TypingBenchmark(const QStringList &fixtures)
+{
+    this->fixtures = fixtures;
+    host = 0;
+    webView = 0;
+    fixtureIndex = -1;
+    failedFixtures = 0;
+    timer = new QTimer(this);
+    clock.start();
+}
+
+void TypingBenchmark::generateFixtures()
+{
+    //small, medium and large documents in a few languages
+    QStringList templates;
+    templates << "function f%1(a, b) {\n  var total = a + b; // %1\n  return total * 2;\n}\n"
+              << "def f%1(a, b):\n    total = a + b  # %1\n    return total * 2\n\n"
+              << "## Section %1\n\nSome *emphasis* and `code` in paragraph %1.\n\n";
+    QStringList extensions;
+    extensions << "js" << "py" << "md";
+    int sizes[] = {1000, 20000, 100000};
+    for(int i = 0; i < 3; i++)
+    {
+        for(int j = 0; j < templates.count(); j++)
+        {
+            QString filePath = temporaryDir.path() + QString("/fixture-%1.%2").arg(sizes[i]).arg(extensions[j]);
+            QFile file(filePath);
+            if(!file.open(QIODevice::WriteOnly))
+            {
+                continue;
+            }
+            QTextStream out(&file);
+            int lines = 0;
+            for(int k = 0; lines < sizes[i]; k++)
+            {
+                QString block = templates[j].arg(k);
+                out << block;
+                lines += block.count('\n');
+            }
+            file.close();
+            fixtures << filePath;
+        }
+    }
+}
+
+void TypingBenchmark::start()
+{
+    if(fixtures.isEmpty())
+    {
+        generateFixtures();
+    }
+    QTextStream(stdout) << QString("%1 %2 %3 %4 %5 %6 %7").arg("fixture", -28).arg("lines", 8).arg("keys", 6)
+                           .arg("p50 ms", 8).arg("p95 ms", 8).arg("p99 ms", 8).arg("dropped", 8) << "\n";
+    nextFixture();
+}
+
+void TypingBenchmark::nextFixture()
+{
+    if(host != 0)
+    {
+        host->deleteLater();
+        host = 0;
+        webView = 0;
+    }
+    fixtureIndex++;
+    if(fixtureIndex >= fixtures.count())
+    {
+        qApp->exit(failedFixtures > 0 ? 1 : 0);
+        return;
+    }
+    //WebView reads its file path from the tab it lives in
+    host = new QTabWidget();
+    host->resize(1200, 800);
+    webView = new WebView(host);
+    int index = host->addTab(webView, QFileInfo(fixtures[fixtureIndex]).fileName());
+    host->setTabToolTip(index, QFileInfo(fixtures[fixtureIndex]).absoluteFilePath());
+    host->show();
+    webView->setFocus();
+    webView->installEventFilter(this);
+    expectedLines = -1;
+    sentKeys = 0;
+    droppedFrames = 0;
+    latencies.clear();
+    pendingKeys.clear();
+    timer->disconnect();
+    connect(timer, SIGNAL(timeout()), this, SLOT(waitForEditor()));
+    loadClock.start();
+    timer->start(50);
+}
+
+void TypingBenchmark::waitForEditor()
+{
+    //ready once Ace holds the whole fixture
+    if(expectedLines == -1 && webView->buffer()->lineCount() > 1)
+    {
+        expectedLines = webView->buffer()->lineCount();
+    }
+    QWebFrame *frame = webView->page()->mainFrame();
+    if(expectedLines == -1 || frame->evaluateJavaScript("editor.session.getLength();").toInt() != expectedLines)
+    {
+        if(loadClock.elapsed() > LoadTimeout)
+        {
+            //a fixture that never loads must not stall the unattended run
+            timer->stop();
+            webView->removeEventFilter(this);
+            failedFixtures++;
+            QTextStream(stdout) << QString("%1 failed to load within %2 s").arg(QFileInfo(fixtures[fixtureIndex]).fileName(), -28).arg(LoadTimeout / 1000) << "\n";
+            nextFixture();
+        }
+        return;
+    }
+    timer->stop();
+    webView->gotoLine(expectedLines / 2);
+    frame->evaluateJavaScript("editor.navigateLineEnd();editor.renderer.updateFull(true);null;");
+    QVariantList position = frame->evaluateJavaScript("(function(){var c = editor.getCursorPosition(); var p = editor.renderer.textToScreenCoordinates(c.row, c.column); return [p.pageY, editor.renderer.lineHeight];})();").toList();
+    editedRow = webView->rect();
+    if(position.count() == 2)
+    {
+        editedRow = QRect(0, (int)position[0].toDouble(), webView->width(), qMax(1, (int)position[1].toDouble()));
+    }
+    timer->disconnect();
+    connect(timer, SIGNAL(timeout()), this, SLOT(sendKey()));
+    timer->setInterval(KeyInterval);
+    QTimer::singleShot(300, timer, SLOT(start()));
+}
+
+void TypingBenchmark::sendKey()
+{
+    qint64 now = clock.elapsed();
+    //keys that never showed up count as timeouts
+    while(!pendingKeys.isEmpty() && now - pendingKeys.first() > Timeout)
+    {
+        latencies << Timeout;
+        droppedFrames += Timeout / 16;
+        pendingKeys.removeFirst();
+    }
+    if(sentKeys >= Keystrokes)
+    {
+        if(pendingKeys.isEmpty())
+        {
+            finishFixture();
+        }
+        return;
+    }
+    QString text = QString(QChar('a' + sentKeys % 26));
+    QKeyEvent press(QEvent::KeyPress, Qt::Key_A + sentKeys % 26, Qt::NoModifier, text);
+    QKeyEvent release(QEvent::KeyRelease, Qt::Key_A + sentKeys % 26, Qt::NoModifier, text);
+    pendingKeys << clock.elapsed();
+    sentKeys++;
+    QCoreApplication::sendEvent(webView, &press);
+    QCoreApplication::sendEvent(webView, &release);
+}
+
+bool TypingBenchmark::eventFilter(QObject *watched, QEvent *event)
+{
+    if(watched != webView || event->type() != QEvent::Paint || pendingKeys.isEmpty())
+    {
+        return false;
+    }
+    if(!((QPaintEvent*)event)->region().intersects(editedRow))
+    {
+        return false;
+    }
+    //paint now so the timestamp is taken once the frame is complete
+    ((QObject*)webView)->event(event);
+    painted();
+    return true;
+}
+
+void TypingBenchmark::painted()
+{
+    qint64 now = clock.elapsed();
+    for(int i = 0; i < pendingKeys.count(); i++)
+    {
+        qint64 latency = now - pendingKeys[i];
+        latencies << latency;
+        droppedFrames += qMax(0, (int)((latency + 15) / 16) - 1); //frames at 60 Hz that passed without the key showing
+    }
+    pendingKeys.clear();
+}
+
+void TypingBenchmark::finishFixture()
+{
+    timer->stop();
+    webView->removeEventFilter(this);
+    std::sort(latencies.begin(), latencies.end());
+    QStringList percentiles;
+    double fractions[] = {0.5, 0.95, 0.99};
+    for(int i = 0; i < 3; i++)
+    {
+        int rank = qMin(latencies.count() - 1, (int)(latencies.count() * fractions[i]));
+        percentiles << (rank >= 0 ? QString::number(latencies[rank]) : QString("-"));
+    }
+    QTextStream(stdout) << QString("%1 %2 %3 %4 %5 %6 %7").arg(QFileInfo(fixtures[fixtureIndex]).fileName(), -28).arg(expectedLines, 8).arg(latencies.count(), 6)
+                           .arg(percentiles[0], 8).arg(percentiles[1], 8).arg(percentiles[2], 8).arg(droppedFrames, 8) << "\n";
+    nextFixture();
+}
@@ -0,0 +1,53 @@
+#ifndef TYPINGBENCHMARK_H
+#define TYPINGBENCHMARK_H
+
+
+#include <QtWidgets>
+
+class WebView;
+
+//types into a WebView and measures the time from each key event to the next paint of the edited row;
+//meant to run unattended, e.g. QT_QPA_PLATFORM=offscreen NeoEditor --benchmark-typing [fixtures...]
+class TypingBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    TypingBenchmark(const QStringList &fixtures);
+    bool eventFilter(QObject *watched, QEvent *event);
+    static const int Keystrokes = 300;
+    static const int KeyInterval = 33;
+    static const int Timeout = 1000;
+    static const int LoadTimeout = 60000;
+
+public slots:
+    void start();
+
+private slots:
+    void nextFixture();
+    void waitForEditor();
+    void sendKey();
+
+private:
+    void generateFixtures();
+    void finishFixture();
+    void painted();
+    QStringList fixtures;
+    QTemporaryDir temporaryDir;
+    QTabWidget *host;
+    WebView *webView;
+    QTimer *timer;
+    QElapsedTimer clock;
+    QElapsedTimer loadClock;
+    QRect editedRow;
+    QList<qint64> pendingKeys;
+    QList<qint64> latencies;
+    int sentKeys;
+    int expectedLines;
+    int droppedFrames;
+    int fixtureIndex;
+    int failedFixtures;
+};
+
+
+#endif // TYPINGBENCHMARK_H
@@ -1,12 +1,80 @@
 #include "webview.h"
+#include "textbuffer.h"
+#include "minimap.h"
+#include "wordindex.h"
+#include "symbolindex.h"
+#include "linediff.h"
+#include "comparedialog.h"
+#include "whitespacenormalizer.h"
+#include "bridgemonitor.h"
+#include "findbar.h"
+#include "longlines.h"
+#include "contentcache.h"
+#include "righttabwidget.h"
+
+const int WebView::LargeDocumentBytes;
+const int WebView::MaxHighlights;
 
 WebView::WebView(QWidget* parent) : QWebView(parent)
 {
     this->mTabWidget = (QTabWidget*)parent;
+    this->textBuffer = new TextBuffer(this);
+    this->minimap = new Minimap(this, textBuffer);
+    this->initialized = false;
+    this->pendingLine = 0;
+    this->activationTimer.start();
+    this->compression = CompressedFile::None;
+    this->streaming = false;
+    this->truncated = false;
+    this->decompressionId = 0;
+    this->structureLanguage = StructureIndex::None;
+    this->nativeStructure = false;
+    this->structureVersion = 0;
+    this->structureTimer = new QTimer(this);
+    this->structureTimer->setSingleShot(true);
+    this->structureTimer->setInterval(1000);
+    connect(structureTimer, SIGNAL(timeout()), this, SLOT(scanStructure()));
+    this->findBar = new FindBar(this);
+    this->safeMode = false;
+    this->plainMode = false;
+    this->safeModeLabel = new QLabel(this);
+    this->safeModeLabel->setAutoFillBackground(true);
+    this->safeModeLabel->setMargin(4);
+    this->safeModeLabel->setCursor(Qt::ArrowCursor);
+    this->safeModeLabel->hide();
+    connect(safeModeLabel, SIGNAL(linkActivated(QString)), this, SLOT(leaveSafeMode(QString)));
+    this->searchTimer = new QTimer(this);
+    this->searchTimer->setSingleShot(true);
+    this->searchTimer->setInterval(100);
+    this->searchGeneration = QSharedPointer<QAtomicInt>(new QAtomicInt(0));
+    this->currentMatch = -1;
+    this->revealMatch = false;
+    this->searchRow = 0;
+    this->searchColumn = 0;
+    this->viewportFirstRow = 0;
+    this->viewportLastRow = 0;
+    this->matchesFirstRow = 0;
+    this->matchesLastRow = -1;
+    connect(searchTimer, SIGNAL(timeout()), this, SLOT(startSearch()));
+    connect(findBar, SIGNAL(queryChanged()), this, SLOT(searchQueryChanged()));
+    connect(findBar, SIGNAL(nextRequested()), this, SLOT(findNextMatch()));
+    connect(findBar, SIGNAL(previousRequested()), this, SLOT(findPreviousMatch()));
+    connect(findBar, SIGNAL(closed()), this, SLOT(closeFind()));
+    connect(textBuffer, SIGNAL(changed(int, QStringList, QStringList)), this, SLOT(indexWords(int, QStringList, QStringList)));
     this->load(QUrl("qrc:///html/editor.html"));
     connect(this, SIGNAL(loadFinished(bool)), this, SLOT(init()));
 }
 
+WebView::~WebView()
+{
+    if(!decompressState.isNull())
+    {
+        decompressState->cancelled.store(1);
+        decompressState->credits.release(8);
+    }
+    WordIndex::instance()->update(textBuffer->lines(), QStringList());
+}
+
 void WebView::debug(QString message)
 {
     qDebug() << message;
@@ -14,6 +82,11 @@ void WebView::debug(QString message)
 
 void WebView::change()
 {
+    BridgeTimer bridgeTimer("qt.change", 0);
+    if(streaming)
+    {
+        return; //appended by the decompressor, not an edit
+    }
     QTabWidget *tabWidget = this->mTabWidget;
     int index = tabWidget->indexOf(this);
     if(index == -1) // tab already closed
@@ -21,61 +94,755 @@ void WebView::change()
         return;
     }
     tabWidget->setTabText(index, "* " + tabWidget->tabText(index));
-    this->page()->mainFrame()->evaluateJavaScript(QString("editor.getSession().removeListener('change', qt.change);null;"));
+    evaluate("change", QString("editor.getSession().removeListener('change', qt.change);null;"));
 }
 
 void WebView::save()
 {
-    int index = this->mTabWidget->indexOf(this);
-    QString filePath = this->mTabWidget->tabToolTip(index);
+    QString filePath = this->filePath();
+    if(streaming || truncated)
+    {
+        QMessageBox::warning(this, tr("Save"), tr("%1 is not completely loaded and can't be saved.").arg(filePath));
+        return;
+    }
+    QString content = safeMode ? LongLines::join(textBuffer->lines(), rowBreaks) : evaluate("save", QString("editor.getValue();")).toString();
+    QByteArray original = content.toUtf8();
+    QByteArray data = WhitespaceNormalizer::normalize(original);
+    if(data.constData() != original.constData() && !safeMode)
+    {
+        //only the lines that were normalized are sent back to the editor
+        QStringList lines = TextBuffer::splitLines(QString::fromUtf8(data));
+        QList<DiffHunk> hunks = LineDiff::diff(textBuffer->lines(), lines);
+        if(!hunks.isEmpty())
+        {
+            applyEdits(LineDiff::edits(textBuffer->lines(), lines, hunks));
+        }
+    }
+    if(compression != CompressedFile::None)
+    {
+        //recompressed unless turned off, in which case the plain text is saved next to the archive
+        //and the tab moves over to it, the archive itself is left as it was
+        QSettings settings("https://github.com/tylerlong/NeoEditor", "NeoEditor");
+        RightTabWidget *rightTabWidget = qobject_cast<RightTabWidget*>(mTabWidget);
+        if(!settings.value("compressOnSave", true).toBool() && rightTabWidget != 0)
+        {
+            QString plainPath = CompressedFile::plainPath(filePath);
+            WebView *plainWebView = rightTabWidget->webView(plainPath);
+            if(plainWebView != 0)
+            {
+                //two tabs on one file would overwrite each other's saves
+                QMessageBox::warning(this, tr("Save"), tr("%1 is already open, it was not overwritten.").arg(plainPath));
+                rightTabWidget->setCurrentWidget(plainWebView);
+                return;
+            }
+            if(QFileInfo(plainPath).exists() && QMessageBox::question(this, tr("Save"), tr("%1 already exists. Overwrite it?").arg(plainPath)) != QMessageBox::Yes)
+            {
+                return;
+            }
+            QFile file(plainPath);
+            if(!file.open(QIODevice::WriteOnly))
+            {
+                return;
+            }
+            file.write(data);
+            file.close();
+            compression = CompressedFile::None;
+            rightTabWidget->rename(filePath, plainPath);
+            SymbolIndex::instance()->updateFile(plainPath);
+            markSaved(data);
+            return;
+        }
+        QByteArray compressed;
+        if(!CompressedFile::compress(compression, data, &compressed))
+        {
+            return;
+        }
+        data = compressed;
+    }
     QFile file(filePath);
     if(!file.open(QIODevice::WriteOnly))
     {
         return;
     }
-    this->page()->mainFrame()->evaluateJavaScript(QString("whitespace.trimTrailingSpace(editor.getSession(), true);null;"));
-    this->page()->mainFrame()->evaluateJavaScript(QString("ensure_newline_at_eof();null;"));
-    QString content = this->page()->mainFrame()->evaluateJavaScript(QString("editor.getValue();")).toString();
-    file.write(content.toUtf8());
+    file.write(data);
     file.close();
+    SymbolIndex::instance()->updateFile(filePath);
+    markSaved(data);
+}
+
+void WebView::markSaved(const QByteArray &content)
+{
+    if(!content.isNull())
+    {
+        savedContentHash = QCryptographicHash::hash(content, QCryptographicHash::Sha1);
+    }
+    int index = this->mTabWidget->indexOf(this);
     QString tabText = this->mTabWidget->tabText(index);
     if(tabText.startsWith("* "))
     {
         this->mTabWidget->setTabText(index, tabText.mid(2));
     }
-    this->page()->mainFrame()->evaluateJavaScript(QString("editor.getSession().on('change', qt.change);null;"));
+    evaluate("markSaved", QString("editor.getSession().removeListener('change', qt.change);editor.getSession().on('change', qt.change);null;"));
+}
+
+//kept for reopening when it is exactly what was read from or written to disk
+void WebView::cacheContent()
+{
+    if(initialized && !streaming && !safeMode && compression == CompressedFile::None && !isModified())
+    {
+        ContentCache::instance()->insert(this->filePath(), textBuffer->text(), savedContentHash);
+    }
+}
+
+bool WebView::isSavedContent(const QByteArray &content)
+{
+    return QCryptographicHash::hash(content, QCryptographicHash::Sha1) == savedContentHash;
+}
+
+QString WebView::filePath()
+{
+    return this->mTabWidget->tabToolTip(this->mTabWidget->indexOf(this));
+}
+
+bool WebView::isModified()
+{
+    return this->mTabWidget->tabText(this->mTabWidget->indexOf(this)).startsWith("* ");
+}
+
+void WebView::reloadFromDisk()
+{
+    if(compression != CompressedFile::None)
+    {
+        if(!streaming)
+        {
+            textBuffer->setText(QString());
+            startDecompression();
+            evaluate("reloadFromDisk", QString("editor.setValue('', -1);null;"));
+        }
+        return;
+    }
+    //only the lines that differ from the disk are replaced, so cursor and undo history survive
+    QFile file(this->filePath());
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return;
+    }
+    QByteArray data = file.readAll();
+    file.close();
+    if(safeMode)
+    {
+        QString content = QString(data);
+        int maxLineLength = LongLines::maxLineLength(content);
+        if(maxLineLength > LongLines::SafeModeColumns)
+        {
+            enterSafeMode(maxLineLength);
+            replaceText(LongLines::chunk(content, &rowBreaks), false);
+        }
+        else
+        {
+            safeMode = false;
+            rowBreaks.clear();
+            safeModeLabel->hide();
+            replaceText(content, false);
+        }
+        markSaved(data);
+        return;
+    }
+    QStringList lines = TextBuffer::splitLines(QString(data));
+    QList<DiffHunk> hunks = LineDiff::diff(textBuffer->lines(), lines);
+    if(!hunks.isEmpty())
+    {
+        applyEdits(LineDiff::edits(textBuffer->lines(), lines, hunks));
+    }
+    markSaved(data);
+}
+
+void WebView::applyEdits(const QVariantList &edits)
+{
+    QString json = QString::fromUtf8(QJsonDocument::fromVariant(edits).toJson(QJsonDocument::Compact));
+    json.replace(QChar(0x2028), "\\u2028").replace(QChar(0x2029), "\\u2029");
+    evaluate("applyEdits", QString("applyEdits(%1);null;").arg(json));
+}
+
+void WebView::compareWithSaved()
+{
+    QByteArray data;
+    if(compression != CompressedFile::None)
+    {
+        if(!CompressedFile::decompress(this->filePath(), compression, &data))
+        {
+            return;
+        }
+    }
+    else
+    {
+        QFile file(this->filePath());
+        if(!file.open(QIODevice::ReadOnly))
+        {
+            return;
+        }
+        data = file.readAll();
+        file.close();
+    }
+    QStringList savedLines = TextBuffer::splitLines(QString(data));
+    CompareDialog *compareDialog = new CompareDialog(this->filePath(), savedLines, textBuffer->lines());
+    compareDialog->setAttribute(Qt::WA_DeleteOnClose);
+    compareDialog->show();
+}
+
+void WebView::applyDelta(bool insert, int startRow, int startColumn, int endRow, int endColumn, QString text)
+{
+    BridgeTimer bridgeTimer("qt.applyDelta", text.length() * sizeof(QChar));
+    if(streaming)
+    {
+        return; //appendChunk already updated the buffer
+    }
+    if(insert)
+    {
+        textBuffer->insert(startRow, startColumn, text);
+    }
+    else
+    {
+        textBuffer->remove(startRow, startColumn, endRow, endColumn);
+    }
+}
+
+void WebView::viewportChanged(int firstRow, int lastRow)
+{
+    BridgeTimer bridgeTimer("qt.viewportChanged", 0);
+    minimap->setViewport(firstRow, lastRow);
+    viewportFirstRow = firstRow;
+    viewportLastRow = lastRow;
+    if(!searchResult.isNull() && (firstRow < matchesFirstRow || lastRow > matchesLastRow))
+    {
+        showMatches();
+    }
+    emit viewportMoved(firstRow, lastRow);
+}
+
+void WebView::scrollToRow(int row)
+{
+    evaluate("scrollToRow", QString("editor.scrollToRow(%1);null;").arg(row));
+}
+
+int WebView::firstVisibleRow()
+{
+    return viewportFirstRow;
+}
+
+void WebView::indexWords(int row, QStringList removedLines, QStringList insertedLines)
+{
+    Q_UNUSED(row);
+    WordIndex::instance()->update(removedLines, insertedLines);
+    if(!searchResult.isNull() || findBar->isVisible())
+    {
+        //positions are stale, search the new text again
+        searchGeneration->fetchAndAddOrdered(1);
+        searchResult.clear();
+        revealMatch = false; //moving the selection would swallow the next keystroke
+        searchTimer->start();
+    }
+    if(structureLanguage != StructureIndex::None)
+    {
+        structureVersion++; //a scan already running describes the old text
+        structureTimer->start();
+    }
+}
+
+void WebView::scanStructure()
+{
+    if(streaming)
+    {
+        return; //rescanned once the last chunk has arrived
+    }
+    structureVersion++;
+    StructureScanner *structureScanner = new StructureScanner(structureVersion, structureLanguage, textBuffer->lines());
+    connect(structureScanner, SIGNAL(scanned(int, StructureIndexPointer)), this, SLOT(structureScanned(int, StructureIndexPointer)));
+    QThreadPool::globalInstance()->start(structureScanner);
+}
+
+void WebView::structureScanned(int version, StructureIndexPointer structureIndex)
+{
+    if(version != structureVersion)
+    {
+        return; //the document changed while scanning
+    }
+    this->structureIndex = structureIndex;
+    if(nativeStructure)
+    {
+        QStringList folds;
+        folds.reserve(structureIndex->folds.count());
+        for(int i = 0; i < structureIndex->folds.count(); i++)
+        {
+            folds << QString::number(structureIndex->folds.at(i));
+        }
+        QString annotations = "[]";
+        if(!structureIndex->error.isNull())
+        {
+            annotations = QString("[{row: %1, column: %2, text: '%3', type: 'error'}]").arg(structureIndex->errorRow).arg(structureIndex->errorColumn).arg(escapeJavascriptString(structureIndex->error));
+        }
+        evaluate("setNativeStructure", QString("setNativeStructure([%1], %2);null;").arg(folds.join(","), annotations));
+    }
+    emit structureChanged();
+}
+
+bool WebView::isLargeDocument()
+{
+    return (qint64)textBuffer->length() * sizeof(QChar) > LargeDocumentBytes;
+}
+
+//Ace's find and highlight-all rescan the whole document on every keystroke
+bool WebView::find(QString selection)
+{
+    BridgeTimer bridgeTimer("qt.find", selection.length() * sizeof(QChar));
+    if(!isLargeDocument() && !findBar->isVisible())
+    {
+        return false;
+    }
+    findBar->open(selection);
+    QSize size = findBar->sizeHint();
+    findBar->setGeometry(qMax(0, this->width() - minimap->width() - size.width() - 16), 0, size.width(), size.height());
+    revealMatch = true;
+    searchTimer->start();
+    return true;
+}
+
+void WebView::searchQueryChanged()
+{
+    revealMatch = true;
+    searchTimer->start();
+}
+
+bool WebView::findNext(bool forward)
+{
+    BridgeTimer bridgeTimer("qt.findNext", 0);
+    if(!findBar->isVisible())
+    {
+        return false;
+    }
+    if(forward)
+    {
+        findNextMatch();
+    }
+    else
+    {
+        findPreviousMatch();
+    }
+    return true;
+}
+
+void WebView::startSearch()
+{
+    if(!findBar->isVisible())
+    {
+        return;
+    }
+    SearchQuery query = findBar->query();
+    int generation = searchGeneration->fetchAndAddOrdered(1) + 1;
+    if(query.text.isEmpty())
+    {
+        searchResult.clear();
+        currentMatch = -1;
+        findBar->setStatus(QString());
+        showMatches();
+        return;
+    }
+    QVariantList cursor = evaluate("startSearch", QString("(function(){var c = editor.getSelectionRange().start; return [c.row, c.column];})();")).toList();
+    searchRow = cursor.value(0).toInt();
+    searchColumn = cursor.value(1).toInt();
+    findBar->setStatus(tr("Searching..."));
+    //refined from the previous result when the query only grew
+    DocumentSearcher *documentSearcher = new DocumentSearcher(generation, searchGeneration, textBuffer->lines(), query, searchResult);
+    connect(documentSearcher, SIGNAL(finished(int, SearchResultPointer)), this, SLOT(searchFinished(int, SearchResultPointer)));
+    QThreadPool::globalInstance()->start(documentSearcher);
+}
+
+void WebView::searchFinished(int generation, SearchResultPointer searchResult)
+{
+    if(generation != searchGeneration->load())
+    {
+        return;
+    }
+    this->searchResult = searchResult;
+    currentMatch = searchResult->firstMatchAfter(searchRow, searchColumn);
+    if(currentMatch != -1 && revealMatch)
+    {
+        selectMatch(currentMatch);
+    }
+    showMatches();
+    updateFindStatus();
+}
+
+void WebView::findNextMatch()
+{
+    if(searchResult.isNull() || searchResult->matches.isEmpty())
+    {
+        return;
+    }
+    currentMatch = (currentMatch + 1) % searchResult->matches.count();
+    selectMatch(currentMatch);
+    updateFindStatus();
+}
+
+void WebView::findPreviousMatch()
+{
+    if(searchResult.isNull() || searchResult->matches.isEmpty())
+    {
+        return;
+    }
+    currentMatch = (currentMatch + searchResult->matches.count() - 1) % searchResult->matches.count();
+    selectMatch(currentMatch);
+    updateFindStatus();
+}
+
+void WebView::closeFind()
+{
+    searchGeneration->fetchAndAddOrdered(1);
+    searchResult.clear();
+    currentMatch = -1;
+    findBar->hide();
+    showMatches();
+    evaluate("closeFind", QString("editor.focus();null;"));
+}
+
+void WebView::selectMatch(int match)
+{
+    int occurrence = searchResult->matches.at(match);
+    int row = searchResult->rows.at(occurrence);
+    int column = searchResult->columns.at(occurrence);
+    evaluate("selectMatch", QString("editor.revealRange(new Range(%1, %2, %1, %3), false);null;").arg(row).arg(column).arg(column + searchResult->lengths.at(occurrence)));
+}
+
+//only the matches within a screen of the viewport are sent, the viewport moving out of them sends the next ones
+void WebView::showMatches()
+{
+    QStringList matches;
+    matchesFirstRow = 0;
+    matchesLastRow = -1;
+    if(!searchResult.isNull())
+    {
+        int margin = qMax(50, viewportLastRow - viewportFirstRow + 1);
+        matchesFirstRow = qMax(0, viewportFirstRow - margin);
+        matchesLastRow = viewportLastRow + margin;
+        for(int i = searchResult->lowerBound(matchesFirstRow); i < searchResult->matches.count(); i++)
+        {
+            int occurrence = searchResult->matches.at(i);
+            int row = searchResult->rows.at(occurrence);
+            if(row > matchesLastRow)
+            {
+                break;
+            }
+            if(matches.count() == MaxHighlights)
+            {
+                matchesLastRow = qMax(row - 1, viewportLastRow);
+                break;
+            }
+            matches << QString("[%1,%2,%3]").arg(row).arg(searchResult->columns.at(occurrence)).arg(searchResult->lengths.at(occurrence));
+        }
+    }
+    evaluate("showMatches", QString("setNativeMatches([%1]);null;").arg(matches.join(",")));
+}
+
+void WebView::updateFindStatus()
+{
+    if(searchResult.isNull())
+    {
+        findBar->setStatus(QString());
+    }
+    else if(!searchResult->error.isNull())
+    {
+        findBar->setStatus(tr("Invalid: %1").arg(searchResult->error));
+    }
+    else if(searchResult->matches.isEmpty())
+    {
+        findBar->setStatus(tr("No results"));
+    }
+    else
+    {
+        findBar->setStatus(tr("%L1 of %L2%3").arg(currentMatch + 1).arg(searchResult->matches.count()).arg(searchResult->truncated ? "+" : ""));
+    }
+}
+
+StructureIndexPointer WebView::structure()
+{
+    return structureIndex;
+}
+
+QVariantList WebView::complete(QString prefix)
+{
+    BridgeTimer bridgeTimer("qt.complete", prefix.length() * sizeof(QChar));
+    return WordIndex::instance()->complete(prefix);
+}
+
+void WebView::gotoLine(int line)
+{
+    if(!initialized) //applied by init() once the document is loaded
+    {
+        pendingLine = line;
+        return;
+    }
+    evaluate("gotoLine", QString("editor.gotoLine(%1, 0, false);editor.focus();null;").arg(line));
+}
+
+QString WebView::wordUnderCursor()
+{
+    return evaluate("wordUnderCursor", QString("(function(){var c = editor.getCursorPosition(); return editor.session.getTextRange(editor.session.getWordRange(c.row, c.column));})();")).toString().trimmed();
+}
+
+void WebView::toggleSplit()
+{
+    if(initialized)
+    {
+        evaluate("toggleSplit", QString("toggleSplit();"));
+    }
+}
+
+void WebView::markActivated()
+{
+    activationTimer.restart();
+}
+
+QVariantMap WebView::resourceUsage(bool detailed)
+{
+    QVariantMap usage;
+    usage.insert("documentBytes", (double)textBuffer->length() * sizeof(QChar));
+    usage.insert("lineCount", textBuffer->lineCount());
+    usage.insert("idleMilliseconds", mTabWidget->currentWidget() == this ? 0.0 : (double)activationTimer.elapsed());
+    usage.insert("editorBytes", -1);
+    usage.insert("undoEntries", -1);
+    usage.insert("undoBytes", -1);
+    if(detailed && initialized)
+    {
+        QVariantMap sample = evaluate("resourceUsage", QString("resourceUsage();")).toMap();
+        for(QVariantMap::const_iterator it = sample.constBegin(); it != sample.constEnd(); ++it)
+        {
+            usage.insert(it.key(), it.value());
+        }
+    }
+    return usage;
+}
+
+TextBuffer *WebView::buffer()
+{
+    return textBuffer;
+}
+
+void WebView::resizeEvent(QResizeEvent *resizeEvent)
+{
+    QWebView::resizeEvent(resizeEvent);
+    minimap->setGeometry(this->width() - minimap->width(), 0, minimap->width(), this->height());
+    QSize size = findBar->sizeHint();
+    findBar->setGeometry(qMax(0, this->width() - minimap->width() - size.width() - 16), 0, size.width(), size.height());
+    size = safeModeLabel->sizeHint();
+    safeModeLabel->setGeometry(0, this->height() - size.height(), this->width() - minimap->width(), size.height());
 }
 
 void WebView::init()
 {
     int index = this->mTabWidget->indexOf(this);
     QString filePath = this->mTabWidget->tabToolTip(index);
-    this->page()->mainFrame()->evaluateJavaScript(QString("setTimeout(function(){editor.getSession().setMode(modelist.getModeForPath('%1').mode);}, 80);null;").arg(escapeJavascriptString(filePath)));
-    QFile file(filePath);
-    if(!file.open(QIODevice::ReadOnly))
+    compression = CompressedFile::format(filePath);
+    structureLanguage = StructureIndex::language(CompressedFile::plainPath(filePath));
+    //Ace's worker reparses the whole document after every change, too slow for large JSON/XML
+    nativeStructure = structureLanguage != StructureIndex::None && (compression != CompressedFile::None || QFileInfo(filePath).size() > LargeDocumentBytes);
+    if(compression != CompressedFile::None)
     {
+        setMode();
+        //decompressed on a worker thread and appended as it arrives
+        this->page()->mainFrame()->addToJavaScriptWindowObject("qt", this);
+        evaluate("init", QString("editor.focus();null;"));
+        evaluate("init", QString("setTimeout(function(){editor.getSession().on('change', qt.change);}, 160);null;"));
+        evaluate("init", QString("setTimeout(function(){attachNative(%1);}, 160);null;").arg(Minimap::Columns));
+        startDecompression();
+        initialized = true;
         return;
     }
-    QString content = QString(file.readAll());
-    file.close();
-    this->page()->mainFrame()->evaluateJavaScript(QString("setTimeout(function(){editor.setValue('%1', -1);}, 80);null;").arg(escapeJavascriptString(content)));
-    this->page()->mainFrame()->evaluateJavaScript(QString("setTimeout(function(){editor.session.getUndoManager().reset();}, 160);null;"));
-    this->page()->mainFrame()->evaluateJavaScript(QString("editor.focus();null;"));
+    QString content;
+    CachedContent cachedContent;
+    if(ContentCache::instance()->take(filePath, &cachedContent))
+    {
+        //prefetched: no disk read, no decoding
+        savedContentHash = cachedContent.hash;
+        content = cachedContent.content;
+    }
+    else
+    {
+        QFile file(filePath);
+        if(!file.open(QIODevice::ReadOnly))
+        {
+            return;
+        }
+        QByteArray data = file.readAll();
+        file.close();
+        savedContentHash = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+        content = QString(data);
+    }
+    int maxLineLength = LongLines::maxLineLength(content);
+    if(maxLineLength > LongLines::SafeModeColumns)
+    {
+        enterSafeMode(maxLineLength);
+        content = LongLines::chunk(content, &rowBreaks);
+    }
+    setMode();
+    textBuffer->setText(content);
+    evaluate("init", QString("setTimeout(function(){editor.setValue('%1', -1);}, 80);null;").arg(escapeJavascriptString(content)));
+    evaluate("init", QString("setTimeout(function(){editor.session.getUndoManager().reset();editor.setReadOnly(%1);}, 160);null;").arg(safeMode ? "true" : "false"));
+    evaluate("init", QString("editor.focus();null;"));
     this->page()->mainFrame()->addToJavaScriptWindowObject("qt", this);
-    this->page()->mainFrame()->evaluateJavaScript(QString("setTimeout(function(){editor.getSession().on('change', qt.change);}, 160);null;"));
+    evaluate("init", QString("setTimeout(function(){editor.getSession().on('change', qt.change);}, 160);null;"));
+    evaluate("init", QString("setTimeout(function(){attachNative(%1);}, 160);null;").arg(Minimap::Columns));
+    if(pendingLine > 0)
+    {
+        evaluate("init", QString("setTimeout(function(){editor.gotoLine(%1, 0, false);}, 160);null;").arg(pendingLine));
+        pendingLine = 0;
+    }
+    initialized = true;
+}
+
+void WebView::setMode()
+{
+    QString filePath = CompressedFile::plainPath(this->filePath());
+    if(plainMode)
+    {
+        //no tokenizer, no worker, wrapped at a fixed column
+        evaluate("setMode", QString("setTimeout(function(){var session = editor.getSession();session.setUseWorker(false);session.setMode('ace/mode/text');session.setUseWrapMode(true);session.setWrapLimitRange(%1, %1);}, 80);null;").arg(LongLines::WrapColumns));
+        return;
+    }
+    evaluate("setMode", QString("setTimeout(function(){var session = editor.getSession();session.setUseWrapMode(false);session.setUseWorker(%1);session.setMode(modelist.getModeForPath('%2').mode);}, 80);null;").arg(nativeStructure ? "false" : "true", escapeJavascriptString(filePath)));
+}
+
+//read-only until pretty-printed or explicitly edited: rows split off a long line can't be
+//told apart from real line breaks once edits and undo move them around
+void WebView::enterSafeMode(int maxLineLength)
+{
+    safeMode = true;
+    plainMode = true;
+    structureLanguage = StructureIndex::None;
+    nativeStructure = false;
+    QString text = tr("Lines up to %L1 characters long, opened read-only without highlighting.").arg(maxLineLength);
+    text += QString(" <a href=\"edit\">%1</a>").arg(tr("Edit anyway"));
+    if(QFileInfo(CompressedFile::plainPath(this->filePath())).suffix().toLower() == "json")
+    {
+        text += QString(" <a href=\"pretty\">%1</a>").arg(tr("Pretty-print"));
+    }
+    safeModeLabel->setText(text);
+    safeModeLabel->show();
+    QSize size = safeModeLabel->sizeHint();
+    safeModeLabel->setGeometry(0, this->height() - size.height(), this->width() - minimap->width(), size.height());
+}
+
+void WebView::leaveSafeMode(QString link)
+{
+    QString text = LongLines::join(textBuffer->lines(), rowBreaks);
+    if(link == "pretty")
+    {
+        safeModeLabel->setText(tr("Pretty-printing..."));
+        PrettyPrinter *prettyPrinter = new PrettyPrinter(text);
+        connect(prettyPrinter, SIGNAL(finished(QString)), this, SLOT(prettyPrinted(QString)));
+        QThreadPool::globalInstance()->start(prettyPrinter);
+        return;
+    }
+    //the whole line is handed to Ace, highlighting stays off
+    safeMode = false;
+    rowBreaks.clear();
+    safeModeLabel->hide();
+    replaceText(text, isModified());
+}
+
+void WebView::prettyPrinted(QString text)
+{
+    int maxLineLength = LongLines::maxLineLength(text);
+    if(maxLineLength > LongLines::SafeModeColumns) //a very long string value
+    {
+        enterSafeMode(maxLineLength);
+        replaceText(LongLines::chunk(text, &rowBreaks), true);
+        return;
+    }
+    safeMode = false;
+    plainMode = false;
+    rowBreaks.clear();
+    safeModeLabel->hide();
+    structureLanguage = StructureIndex::language(CompressedFile::plainPath(this->filePath()));
+    nativeStructure = structureLanguage != StructureIndex::None && (qint64)text.length() * sizeof(QChar) > LargeDocumentBytes;
+    setMode();
+    replaceText(text, true);
+}
+
+//the whole document at once, mirrored into the native buffer by the delta listener
+void WebView::replaceText(const QString &text, bool modified)
+{
+    QString listener = modified ? QString() : QString("session.removeListener('change', qt.change);");
+    evaluate("replaceText", QString("(function(){var session = editor.getSession();%1editor.setValue('%2', -1);session.getUndoManager().reset();%3editor.setReadOnly(%4);})();null;")
+             .arg(listener, escapeJavascriptString(text), modified ? QString() : QString("session.on('change', qt.change);"), safeMode ? "true" : "false"));
+}
+
+void WebView::startDecompression()
+{
+    if(!decompressState.isNull())
+    {
+        decompressState->cancelled.store(1);
+        decompressState->credits.release(8);
+    }
+    streaming = true;
+    truncated = false;
+    decompressState = QSharedPointer<DecompressState>(new DecompressState());
+    decompressionId++;
+    Decompressor *decompressor = new Decompressor(decompressionId, this->filePath(), compression, decompressState);
+    connect(decompressor, SIGNAL(chunk(int, QString)), this, SLOT(appendChunk(int, QString)));
+    connect(decompressor, SIGNAL(finished(int, bool, bool, QByteArray, QString)), this, SLOT(decompressionFinished(int, bool, bool, QByteArray, QString)));
+    QThreadPool::globalInstance()->start(decompressor);
+    //edits made while chunks are still arriving would be skipped by the native buffer
+    evaluate("startDecompression", QString("editor.setReadOnly(true);null;"));
+}
+
+void WebView::appendChunk(int id, QString text)
+{
+    if(id != decompressionId)
+    {
+        return; //queued before a reload restarted the decompression
+    }
+    int lastRow = textBuffer->lineCount() - 1;
+    textBuffer->insert(lastRow, textBuffer->lines().at(lastRow).length(), text);
+    evaluate("appendChunk", QString("(function(){var doc = editor.getSession().getDocument(); doc.insert({row: doc.getLength(), column: 0}, '%1');})();null;").arg(escapeJavascriptString(text)));
+    decompressState->credits.release();
+}
+
+void WebView::decompressionFinished(int id, bool ok, bool truncated, QByteArray compressedHash, QString error)
+{
+    if(id != decompressionId)
+    {
+        return;
+    }
+    streaming = false;
+    this->truncated = truncated;
+    savedContentHash = compressedHash;
+    if(structureLanguage != StructureIndex::None)
+    {
+        structureTimer->start();
+    }
+    evaluate("decompressionFinished", QString("editor.session.getUndoManager().reset();editor.setReadOnly(%1);null;").arg(truncated ? "true" : "false"));
+    int index = this->mTabWidget->indexOf(this);
+    if(truncated)
+    {
+        this->mTabWidget->setTabText(index, this->mTabWidget->tabText(index) + tr(" [truncated]"));
+    }
+    if(!ok)
+    {
+        QMessageBox::warning(this, tr("Open"), tr("Failed to decompress %1: %2").arg(this->filePath(), error));
+    }
 }
 
 void WebView::contextMenuEvent(QContextMenuEvent *contextMenuEvent)
 {
-    double gutterWidth = this->page()->mainFrame()->evaluateJavaScript(QString("editor.renderer.$gutterLayer.gutterWidth;")).toDouble();
-    if(contextMenuEvent->pos().x() <= gutterWidth)
+    //gutter width and selection state in a single round trip
+    QVariantList state = evaluate("contextMenu", QString("[editor.renderer.$gutterLayer.gutterWidth, editor.selection.isEmpty()];")).toList();
+    if(state.count() != 2 || contextMenuEvent->pos().x() <= state.at(0).toDouble())
     {
         return;
     }
 
     QMenu menu;
-    QString selected = this->page()->mainFrame()->evaluateJavaScript(QString("editor.getSelectedText();")).toString();
-    if(selected.isEmpty())
+    if(state.at(1).toBool())
     {
         menu.addAction(this->pageAction(QWebPage::Paste));
         menu.addAction(this->pageAction(QWebPage::SelectAll));
@@ -86,9 +853,38 @@ void WebView::contextMenuEvent(QContextMenuEvent *contextMenuEvent)
         menu.addAction(this->pageAction(QWebPage::Cut));
         menu.addAction(this->pageAction(QWebPage::Paste));
     }
+    menu.addSeparator();
+    QAction *compareAction = menu.addAction(tr("Compare with &Saved"));
+    connect(compareAction, SIGNAL(triggered()), this, SLOT(compareWithSaved()));
+    if(compression != CompressedFile::None)
+    {
+        QSettings settings("https://github.com/tylerlong/NeoEditor", "NeoEditor");
+        QAction *compressAction = menu.addAction(tr("Compress on Sa&ve"));
+        compressAction->setCheckable(true);
+        compressAction->setChecked(settings.value("compressOnSave", true).toBool());
+        connect(compressAction, SIGNAL(toggled(bool)), this, SLOT(setCompressOnSave(bool)));
+    }
     menu.exec(mapToGlobal(contextMenuEvent->pos()));
 }
 
+void WebView::setCompressOnSave(bool compressOnSave)
+{
+    QSettings settings("https://github.com/tylerlong/NeoEditor", "NeoEditor");
+    settings.setValue("compressOnSave", compressOnSave);
+}
+
+QVariant WebView::evaluate(const char *callSite, const QString &script)
+{
+    //every call into the page blocks the GUI thread, so all of them are timed
+    BridgeTimer bridgeTimer(callSite, script.length() * sizeof(QChar));
+    QVariant result = this->page()->mainFrame()->evaluateJavaScript(script);
+    if(result.type() == QVariant::String)
+    {
+        bridgeTimer.addPayload(result.toString().length() * sizeof(QChar));
+    }
+    return result;
+}
+
 QString WebView::escapeJavascriptString(const QString &input)
 {
     QString output;
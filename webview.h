@@ -3,6 +3,13 @@
 
 
 #include <QtWebKitWidgets>
+#include "compressedfile.h"
+#include "structureindex.h"
+#include "documentsearch.h"
+
+class TextBuffer;
+class Minimap;
+class FindBar;
 
 class WebView : public QWebView
 {
@@ -10,21 +17,106 @@ class WebView : public QWebView
 
 public:
     WebView(QWidget* parent);
+    ~WebView();
     void save();
+    void reloadFromDisk();
+    void applyEdits(const QVariantList &edits);
+    QString filePath();
+    bool isModified();
+    bool isSavedContent(const QByteArray &content);
+    void cacheContent();
+    void markActivated();
+    QVariantMap resourceUsage(bool detailed);
+    void scrollToRow(int row);
+    int firstVisibleRow();
+    void gotoLine(int line);
+    QString wordUnderCursor();
+    void toggleSplit();
+    TextBuffer *buffer();
+    StructureIndexPointer structure();
+    static const int LargeDocumentBytes = 2 * 1024 * 1024;
+    static const int MaxHighlights = 2000;
+
+signals:
+    void structureChanged();
+    void viewportMoved(int firstRow, int lastRow);
 
 protected:
     void contextMenuEvent(QContextMenuEvent *contextMenuEvent);
+    void resizeEvent(QResizeEvent *resizeEvent);
 
 protected slots:
     void debug(QString message);
     void change();
+    void applyDelta(bool insert, int startRow, int startColumn, int endRow, int endColumn, QString text);
+    void viewportChanged(int firstRow, int lastRow);
+    void compareWithSaved();
+    QVariantList complete(QString prefix);
+    bool find(QString selection);
+    bool findNext(bool forward);
 
 private slots:
+    void indexWords(int row, QStringList removedLines, QStringList insertedLines);
     void init();
+    void appendChunk(int id, QString text);
+    void decompressionFinished(int id, bool ok, bool truncated, QByteArray compressedHash, QString error);
+    void scanStructure();
+    void structureScanned(int version, StructureIndexPointer structureIndex);
+    void searchQueryChanged();
+    void startSearch();
+    void searchFinished(int generation, SearchResultPointer searchResult);
+    void findNextMatch();
+    void findPreviousMatch();
+    void closeFind();
+    void leaveSafeMode(QString link);
+    void prettyPrinted(QString text);
+    void setCompressOnSave(bool compressOnSave);
 
 private:
+    void markSaved(const QByteArray &content);
+    void startDecompression();
+    void selectMatch(int match);
+    void showMatches();
+    void updateFindStatus();
+    bool isLargeDocument();
+    void setMode();
+    void enterSafeMode(int maxLineLength);
+    void replaceText(const QString &text, bool modified);
+    QVariant evaluate(const char *callSite, const QString &script);
     QString escapeJavascriptString(const QString &input);
     QTabWidget *mTabWidget;
+    TextBuffer *textBuffer;
+    Minimap *minimap;
+    bool initialized;
+    int pendingLine;
+    QByteArray savedContentHash;
+    QElapsedTimer activationTimer;
+    CompressedFile::Format compression;
+    QSharedPointer<DecompressState> decompressState;
+    bool streaming;
+    bool truncated;
+    int decompressionId;
+    StructureIndex::Language structureLanguage;
+    StructureIndexPointer structureIndex;
+    bool nativeStructure;
+    int structureVersion;
+    QTimer *structureTimer;
+    FindBar *findBar;
+    QTimer *searchTimer;
+    QSharedPointer<QAtomicInt> searchGeneration;
+    SearchResultPointer searchResult;
+    int currentMatch;
+    bool revealMatch;
+    int searchRow;
+    int searchColumn;
+    int viewportFirstRow;
+    int viewportLastRow;
+    int matchesFirstRow;
+    int matchesLastRow;
+    bool safeMode;
+    bool plainMode;
+    QStringList rowBreaks;
+    QLabel *safeModeLabel;
 };
 
 
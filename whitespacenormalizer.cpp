@@ -0,0 +1,155 @@
+#include "whitespacenormalizer.h"
+#include "projectfiles.h"
+#include <string.h>
+
+WhitespaceNormalizer::WhitespaceNormalizer()
+{
+    lastBreak = "\n";
+    hasContent = false;
+}
+
+bool WhitespaceNormalizer::isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+void WhitespaceNormalizer::write(const char *data, int size, QByteArray &out)
+{
+    //memchr and memcpy do the bulk of the work, both are vectorized by the C library;
+    //only the whitespace run at the end of a line is looked at byte by byte
+    const char *end = data + size;
+    while(data < end)
+    {
+        const char *newline = (const char*)memchr(data, '\n', end - data);
+        const char *lineEnd = newline != 0 ? newline : end;
+        const char *contentEnd = lineEnd;
+        while(contentEnd > data && isSpace(contentEnd[-1]))
+        {
+            contentEnd--;
+        }
+        if(contentEnd > data)
+        {
+            //blank lines and spaces are only written once something follows them
+            out += pendingBreaks;
+            out += pendingSpace;
+            out.append(data, contentEnd - data);
+            pendingBreaks.clear();
+            pendingSpace.clear();
+            hasContent = true;
+        }
+        if(newline == 0)
+        {
+            pendingSpace.append(contentEnd, end - contentEnd);
+            break;
+        }
+        bool carriageReturn = lineEnd > data ? lineEnd[-1] == '\r' : pendingSpace.endsWith('\r');
+        lastBreak = carriageReturn ? "\r\n" : "\n";
+        pendingBreaks += lastBreak;
+        pendingSpace.clear();
+        data = newline + 1;
+    }
+}
+
+void WhitespaceNormalizer::finish(QByteArray &out)
+{
+    if(hasContent)
+    {
+        out += pendingBreaks.isEmpty() ? lastBreak : pendingBreaks.left(pendingBreaks.startsWith('\r') ? 2 : 1);
+    }
+    pendingBreaks.clear();
+    pendingSpace.clear();
+    lastBreak = "\n";
+    hasContent = false;
+}
+
+QByteArray WhitespaceNormalizer::normalize(const QByteArray &content)
+{
+    WhitespaceNormalizer normalizer;
+    QByteArray out;
+    out.reserve(content.size() + 2);
+    normalizer.write(content.constData(), content.size(), out);
+    normalizer.finish(out);
+    if(out == content)
+    {
+        return content; //shares the original data
+    }
+    return out;
+}
+
+bool WhitespaceNormalizer::normalizeFile(const QString &filePath, bool *changed)
+{
+    *changed = false;
+    QFile file(filePath);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+    QByteArray content = file.readAll();
+    file.close();
+    if(!ProjectFiles::isText(content))
+    {
+        return true;
+    }
+    QByteArray normalized = normalize(content);
+    if(normalized.constData() == content.constData())
+    {
+        return true;
+    }
+    QSaveFile saveFile(filePath);
+    if(!saveFile.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+    saveFile.write(normalized);
+    if(!saveFile.commit())
+    {
+        return false;
+    }
+    *changed = true;
+    return true;
+}
+
+int WhitespaceNormalizer::normalizeFolder(const QString &folderPath)
+{
+    //headless: no widget is created, the files are spread over every core
+    QTextStream out(stdout);
+    QFileInfo folderInfo(folderPath);
+    if(!folderInfo.isDir())
+    {
+        out << QString("%1 is not a folder").arg(folderPath) << endl;
+        return 2;
+    }
+    QStringList filePaths = ProjectFiles::list(folderInfo.absoluteFilePath());
+    QAtomicInt changedCount(0);
+    QAtomicInt failedCount(0);
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(QThread::idealThreadCount());
+    for(int i = 0; i < filePaths.count(); i++)
+    {
+        threadPool.start(new NormalizeTask(filePaths[i], &changedCount, &failedCount));
+    }
+    threadPool.waitForDone();
+    out << QString("%1 files checked, %2 normalized, %3 failed").arg(filePaths.count()).arg(changedCount.load()).arg(failedCount.load()) << endl;
+    return failedCount.load() == 0 ? 0 : 1;
+}
+
+NormalizeTask::NormalizeTask(const QString &filePath, QAtomicInt *changedCount, QAtomicInt *failedCount)
+{
+    this->filePath = filePath;
+    this->changedCount = changedCount;
+    this->failedCount = failedCount;
+}
+
+void NormalizeTask::run()
+{
+    bool changed;
+    if(!WhitespaceNormalizer::normalizeFile(filePath, &changed))
+    {
+        failedCount->ref();
+        QTextStream(stderr) << QString("failed to normalize %1").arg(filePath) << endl;
+    }
+    else if(changed)
+    {
+        changedCount->ref();
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef WHITESPACENORMALIZER_H
+#define WHITESPACENORMALIZER_H
+
+
+#include <QtCore>
+
+//trims trailing whitespace of every line and leaves exactly one newline at the end of the file
+//input is fed in chunks of UTF-8 bytes; CRLF line breaks are kept as they are
+class WhitespaceNormalizer
+{
+public:
+    WhitespaceNormalizer();
+    void write(const char *data, int size, QByteArray &out);
+    void finish(QByteArray &out);
+    static QByteArray normalize(const QByteArray &content);
+    static bool normalizeFile(const QString &filePath, bool *changed);
+    static int normalizeFolder(const QString &folderPath);
+
+private:
+    static bool isSpace(char c);
+    QByteArray pendingSpace;
+    QByteArray pendingBreaks;
+    QByteArray lastBreak;
+    bool hasContent;
+};
+
+class NormalizeTask : public QRunnable
+{
+public:
+    NormalizeTask(const QString &filePath, QAtomicInt *changedCount, QAtomicInt *failedCount);
+    void run();
+
+private:
+    QString filePath;
+    QAtomicInt *changedCount;
+    QAtomicInt *failedCount;
+};
+
+
+#endif // WHITESPACENORMALIZER_H
@@ -0,0 +1,195 @@
+#include "wordindex.h"
+#include "projectfiles.h"
+
+const int WordIndex::MinWordLength;
+const int WordIndex::MaxCompletions;
+const int WordIndex::MaxCandidates;
+
+WordIndex::WordIndex()
+{
+    nextGeneration = 0;
+}
+
+WordIndex *WordIndex::instance()
+{
+    static WordIndex wordIndex;
+    return &wordIndex;
+}
+
+void WordIndex::countWords(const QString &text, QHash<QString, int> &counts, int weight)
+{
+    const QChar *data = text.constData();
+    int length = text.length();
+    int i = 0;
+    while(i < length)
+    {
+        QChar c = data[i];
+        if(!(c.isLetter() || c == '_' || c == '$'))
+        {
+            i++;
+            continue;
+        }
+        int start = i;
+        while(i < length && (data[i].isLetterOrNumber() || data[i] == '_' || data[i] == '$'))
+        {
+            i++;
+        }
+        if(i - start >= MinWordLength)
+        {
+            counts[QString(data + start, i - start)] += weight;
+        }
+    }
+}
+
+void WordIndex::merge(const QHash<QString, int> &counts)
+{
+    QHash<QString, int>::const_iterator i;
+    for(i = counts.constBegin(); i != counts.constEnd(); ++i)
+    {
+        if(i.value() == 0)
+        {
+            continue;
+        }
+        QMap<QString, int>::iterator word = words.find(i.key());
+        if(word == words.end())
+        {
+            if(i.value() > 0)
+            {
+                words.insert(i.key(), i.value());
+            }
+            continue;
+        }
+        word.value() += i.value();
+        if(word.value() <= 0)
+        {
+            words.erase(word);
+        }
+    }
+}
+
+void WordIndex::update(const QStringList &removedLines, const QStringList &insertedLines)
+{
+    //net difference first, so typing inside a word touches one or two entries
+    QHash<QString, int> counts;
+    foreach(const QString &line, removedLines)
+    {
+        countWords(line, counts, -1);
+    }
+    foreach(const QString &line, insertedLines)
+    {
+        countWords(line, counts, 1);
+    }
+    QWriteLocker locker(&lock);
+    merge(counts);
+}
+
+void WordIndex::addFolder(const QString &folderPath)
+{
+    int generation;
+    {
+        QWriteLocker locker(&lock);
+        if(folderGenerations.contains(folderPath))
+        {
+            return;
+        }
+        generation = nextGeneration++;
+        folderGenerations.insert(folderPath, generation);
+        folderWords.insert(folderPath, QHash<QString, int>());
+    }
+    QThreadPool::globalInstance()->start(new FolderWordIndexer(this, folderPath, generation));
+}
+
+void WordIndex::removeFolder(const QString &folderPath)
+{
+    QWriteLocker locker(&lock);
+    folderGenerations.remove(folderPath);
+    QHash<QString, int> counts = folderWords.take(folderPath);
+    QHash<QString, int>::iterator i;
+    for(i = counts.begin(); i != counts.end(); ++i)
+    {
+        i.value() = -i.value();
+    }
+    merge(counts);
+}
+
+bool WordIndex::isIndexing(const QString &folderPath, int generation)
+{
+    return folderGenerations.value(folderPath, -1) == generation;
+}
+
+QVariantList WordIndex::complete(const QString &prefix)
+{
+    QMultiMap<int, QString> candidates;
+    {
+        QReadLocker locker(&lock);
+        int scanned = 0;
+        QMap<QString, int>::const_iterator i = words.lowerBound(prefix);
+        for(; i != words.constEnd() && i.key().startsWith(prefix) && scanned < MaxCandidates; ++i, scanned++)
+        {
+            if(i.key() == prefix)
+            {
+                continue;
+            }
+            candidates.insert(i.value(), i.key());
+            if(candidates.count() > MaxCompletions)
+            {
+                candidates.erase(candidates.begin());
+            }
+        }
+    }
+    QVariantList completions;
+    QMultiMap<int, QString>::const_iterator i = candidates.constEnd();
+    while(i != candidates.constBegin())
+    {
+        --i;
+        QVariantMap completion;
+        completion.insert("caption", i.value());
+        completion.insert("value", i.value());
+        completion.insert("score", i.key());
+        completion.insert("meta", "word");
+        completions << completion;
+    }
+    return completions;
+}
+
+FolderWordIndexer::FolderWordIndexer(WordIndex *wordIndex, QString folderPath, int generation)
+{
+    this->wordIndex = wordIndex;
+    this->folderPath = folderPath;
+    this->generation = generation;
+}
+
+void FolderWordIndexer::run()
+{
+    QStringList filePaths = ProjectFiles::list(folderPath);
+    foreach(const QString &filePath, filePaths)
+    {
+        QFile file(filePath);
+        if(!file.open(QIODevice::ReadOnly))
+        {
+            continue;
+        }
+        QByteArray content = file.readAll();
+        file.close();
+        if(!ProjectFiles::isText(content))
+        {
+            continue;
+        }
+        QHash<QString, int> counts;
+        WordIndex::countWords(QString::fromUtf8(content), counts, 1);
+
+        //merged file by file so queries never wait long for the lock
+        QWriteLocker locker(&wordIndex->lock);
+        if(!wordIndex->isIndexing(folderPath, generation))
+        {
+            return;
+        }
+        QHash<QString, int> &folderCounts = wordIndex->folderWords[folderPath];
+        QHash<QString, int>::const_iterator i;
+        for(i = counts.constBegin(); i != counts.constEnd(); ++i)
+        {
+            folderCounts[i.key()] += i.value();
+        }
+        wordIndex->merge(counts);
+    }
+}
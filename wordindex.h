@@ -0,0 +1,46 @@
+#ifndef WORDINDEX_H
+#define WORDINDEX_H
+
+
+#include <QtCore>
+
+//words of all open buffers and opened folders, sorted for prefix queries
+class WordIndex
+{
+public:
+    static WordIndex *instance();
+    void update(const QStringList &removedLines, const QStringList &insertedLines);
+    void addFolder(const QString &folderPath);
+    void removeFolder(const QString &folderPath);
+    QVariantList complete(const QString &prefix);
+    static void countWords(const QString &text, QHash<QString, int> &counts, int weight);
+    static const int MinWordLength = 3;
+    static const int MaxCompletions = 40;
+    static const int MaxCandidates = 4096;
+
+private:
+    WordIndex();
+    void merge(const QHash<QString, int> &counts);
+    bool isIndexing(const QString &folderPath, int generation);
+    QMap<QString, int> words;
+    QHash<QString, QHash<QString, int> > folderWords;
+    QHash<QString, int> folderGenerations;
+    int nextGeneration;
+    QReadWriteLock lock;
+    friend class FolderWordIndexer;
+};
+
+class FolderWordIndexer : public QRunnable
+{
+public:
+    FolderWordIndexer(WordIndex *wordIndex, QString folderPath, int generation);
+    void run();
+
+private:
+    WordIndex *wordIndex;
+    QString folderPath;
+    int generation;
+};
+
+
+#endif // WORDINDEX_H